@@ -0,0 +1,251 @@
+#include "cache.h"
+#include "../util/hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_PATH_SIZE 4096
+
+static const char padding[8] = {0};
+
+/*
+ * Private helpers
+ */
+
+bool cachePath(char* path, const char* directory, uint64_t key, const char* suffix)
+{
+    int length = snprintf(path, CACHE_PATH_SIZE, "%s/%016llx%s", directory, (unsigned long long)key, suffix);
+    return length > 0 && length < CACHE_PATH_SIZE;
+}
+
+// Sections follow the header in the order of their kinds
+void addSection(CacheHeader* header, CacheSectionKind kind, size_t* end, size_t size)
+{
+    header->sections[kind].offset = *end;
+    header->sections[kind].size   = size;
+    *end                          = (*end + size + 7) & ~(size_t)7;
+}
+
+bool writeSection(FILE* file, const CacheHeader* header, CacheSectionKind kind, const void* data)
+{
+    return writeAligned(file, data, (size_t)header->sections[kind].size);
+}
+
+/*
+ * Compile cache
+ */
+
+uint64_t cacheKey(const char* source, size_t size)
+{
+    return hashBytes(source, size, CACHE_VERSION);
+}
+
+bool openCacheEntry(CacheEntry* entry, const char* directory, uint64_t key, size_t sourceSize)
+{
+    char path[CACHE_PATH_SIZE];
+    entry->header = NULL;
+    if(!cachePath(path, directory, key, ".dcache") || !openInput(&entry->input, path))
+        return false;
+
+    // Streamed files are not cache files
+    const CacheHeader* header = (const CacheHeader*)entry->input.data;
+    size_t             size   = entry->input.size;
+    if(entry->input.mode != InputMapped || size < sizeof(CacheHeader) || header->magic != CACHE_MAGIC ||
+       header->version != CACHE_VERSION || header->key != key || header->sourceSize != sourceSize)
+    {
+        closeCacheEntry(entry);
+        return false;
+    }
+
+    for(int kind = 0; kind < CSCount; ++kind)
+    {
+        const CacheSection* section = &header->sections[kind];
+        if(section->offset % 8 != 0 || section->offset > size || section->size > size - section->offset)
+        {
+            closeCacheEntry(entry);
+            return false;
+        }
+    }
+
+    entry->header = header;
+    return true;
+}
+
+void closeCacheEntry(CacheEntry* entry)
+{
+    closeInput(&entry->input);
+    entry->header = NULL;
+}
+
+const void* cacheSection(const CacheEntry* entry, CacheSectionKind kind, size_t* size)
+{
+    *size = (size_t)entry->header->sections[kind].size;
+    return entry->input.data + entry->header->sections[kind].offset;
+}
+
+void viewCachedAst(const CacheEntry* entry, Ast* ast)
+{
+    size_t size;
+    ast->nodes.data           = (char*)cacheSection(entry, CSNodes, &size);
+    ast->nodes.size           = size;
+    ast->nodes.capacity       = size;
+    ast->expressions.data     = (char*)cacheSection(entry, CSExpressions, &size);
+    ast->expressions.size     = size;
+    ast->expressions.capacity = size;
+    ast->root                 = entry->header->root;
+}
+
+const char* cachedSymbol(const CacheEntry* entry, SymbolId symbol, unsigned* length)
+{
+    size_t                textSize;
+    size_t                stringsSize;
+    const char*           text    = cacheSection(entry, CSSymbolText, &textSize);
+    const InternedString* strings = cacheSection(entry, CSSymbols, &stringsSize);
+    if(symbol == SYMBOL_NONE || symbol > stringsSize / sizeof(InternedString))
+        return NULL;
+
+    const InternedString* string = &strings[symbol - 1];
+    if(string->offset > textSize || string->length > textSize - string->offset)
+        return NULL;
+
+    *length = string->length;
+    return text + string->offset;
+}
+
+bool internCachedSymbols(const CacheEntry* entry, Interner* interner)
+{
+    size_t                textSize;
+    size_t                stringsSize;
+    const char*           text    = cacheSection(entry, CSSymbolText, &textSize);
+    const InternedString* strings = cacheSection(entry, CSSymbols, &stringsSize);
+    if(stringsSize != entry->header->symbolCount * sizeof(InternedString))
+        return false;
+
+    for(uint32_t i = 0; i < entry->header->symbolCount; ++i)
+    {
+        if(strings[i].offset > textSize || strings[i].length > textSize - strings[i].offset)
+            return false;
+        if(intern(interner, text + strings[i].offset, strings[i].length) != i + 1)
+            return false;
+    }
+    return true;
+}
+
+bool storeCacheEntry(const char* directory, uint64_t key, size_t sourceSize, const CacheUnit* unit, unsigned writer)
+{
+    const Interner* interner = unit->interner;
+    uint32_t        symbols  = interner->count > 0 ? interner->count - 1 : 0;
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic       = CACHE_MAGIC;
+    header.version     = CACHE_VERSION;
+    header.key         = key;
+    header.sourceSize  = sourceSize;
+    header.symbolCount = symbols;
+    header.root        = unit->ast->root;
+    header.succeeded   = unit->succeeded;
+    header.resolved    = unit->resolved;
+
+    size_t end = (sizeof(CacheHeader) + 7) & ~(size_t)7;
+    addSection(&header, CSSymbols, &end, symbols * sizeof(InternedString));
+    addSection(&header, CSSymbolText, &end, interner->text.size);
+    addSection(&header, CSStrings, &end, unit->strings->size);
+    addSection(&header, CSNodes, &end, unit->ast->nodes.size);
+    addSection(&header, CSExpressions, &end, unit->ast->expressions.size);
+    addSection(&header, CSMessages, &end, unit->messages->size);
+    addSection(&header, CSStamps, &end, unit->stampCount * sizeof(CacheStamp));
+
+    char path[CACHE_PATH_SIZE];
+    char temporary[CACHE_PATH_SIZE];
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%u.tmp", writer);
+    if(!cachePath(path, directory, key, ".dcache") || !cachePath(temporary, directory, key, suffix))
+        return false;
+
+    FILE* file = fopen(temporary, "wb");
+    if(file == NULL)
+        return false;
+
+    bool written = writeAligned(file, &header, sizeof(header)) &&
+                   writeSection(file, &header, CSSymbols, interner->strings + 1) &&
+                   writeSection(file, &header, CSSymbolText, interner->text.data) &&
+                   writeSection(file, &header, CSStrings, unit->strings->data) &&
+                   writeSection(file, &header, CSNodes, unit->ast->nodes.data) &&
+                   writeSection(file, &header, CSExpressions, unit->ast->expressions.data) &&
+                   writeSection(file, &header, CSMessages, unit->messages->text) &&
+                   writeSection(file, &header, CSStamps, unit->stamps);
+
+    if(fclose(file) != 0 || !written)
+    {
+        remove(temporary);
+        return false;
+    }
+    return replaceFile(temporary, path);
+}
+
+void initializeCacheShelf(CacheShelf* shelf)
+{
+    shelf->entries = NULL;
+}
+
+void finalizeCacheShelf(CacheShelf* shelf)
+{
+    for(size_t i = 0; shelf->entries != NULL && i < CACHE_SHELF_SLOTS; ++i)
+        if(shelf->entries[i].header != NULL)
+            closeCacheEntry(&shelf->entries[i]);
+
+    free(shelf->entries);
+    shelf->entries = NULL;
+}
+
+CacheEntry* shelveCacheEntry(CacheShelf* shelf, const char* directory, uint64_t key, size_t sourceSize)
+{
+    if(shelf->entries == NULL)
+    {
+        // Zeroed entries have nothing mapped
+        shelf->entries = calloc(CACHE_SHELF_SLOTS, sizeof(CacheEntry));
+        if(shelf->entries == NULL)
+            return NULL;
+    }
+
+    // Keys are hashes already
+    CacheEntry* entry = &shelf->entries[key % CACHE_SHELF_SLOTS];
+    if(entry->header != NULL && entry->header->key == key && entry->header->sourceSize == sourceSize)
+        return entry;
+
+    if(entry->header != NULL)
+        closeCacheEntry(entry);
+    return openCacheEntry(entry, directory, key, sourceSize) ? entry : NULL;
+}
+
+void dropCacheEntry(CacheShelf* shelf, uint64_t key)
+{
+    CacheEntry* entry = shelf->entries != NULL ? &shelf->entries[key % CACHE_SHELF_SLOTS] : NULL;
+    if(entry != NULL && entry->header != NULL && entry->header->key == key)
+        closeCacheEntry(entry);
+}
+
+/*
+ * Helper
+ */
+
+bool writeAligned(FILE* file, const void* data, size_t size)
+{
+    size_t pad = ((size + 7) & ~(size_t)7) - size;
+    if(size > 0 && fwrite(data, 1, size, file) != size)
+        return false;
+    return fwrite(padding, 1, pad, file) == pad;
+}
+
+bool replaceFile(const char* temporary, const char* path)
+{
+    // Another compile may have written the same file first, Windows does not rename over it
+    remove(path);
+    if(rename(temporary, path) != 0)
+    {
+        remove(temporary);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef HEADER_CACHE
+#define HEADER_CACHE
+
+#include "../lexer/input.h"
+#include "../parser/ast.h"
+#include "../util/arena.h"
+#include "../util/interner.h"
+#include "../util/text.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Compile cache
+ */
+
+// Version of the compiler and the cache format, bump it whenever symbols, trees or diagnostics change
+#define CACHE_VERSION 5
+
+#define CACHE_MAGIC 0x43445544  // "DUDC"
+
+// Parts of a cache file, each is aligned to eight bytes. A hit needs the tree and
+// the symbols it refers to, the tokens are not kept.
+typedef enum CacheSectionKind
+{
+    CSSymbols,     // InternedString of each symbol from 1 on
+    CSSymbolText,  // Text of the interner
+    CSStrings,     // Decoded string constants of the lexer
+    CSNodes,
+    CSExpressions,
+    CSMessages,
+    CSStamps,
+    CSCount
+} CacheSectionKind;
+
+typedef struct CacheSection
+{
+    uint64_t offset;  // From the begin of the file
+    uint64_t size;
+} CacheSection;
+
+// Interface of a module a source uses, its results are only valid while the interface stays the same
+typedef struct CacheStamp
+{
+    SymbolId name;
+    uint32_t unused;
+    uint64_t hash;  // Of the interface, 0 if there was none
+} CacheStamp;
+
+// Everything in the file is addressed by offset or index, so it is used where it is mapped
+typedef struct CacheHeader
+{
+    uint32_t     magic;
+    uint32_t     version;
+    uint64_t     key;
+    uint64_t     sourceSize;
+    uint32_t     symbolCount;
+    uint32_t     root;
+    uint32_t     succeeded;
+    uint32_t     resolved;  // Uses were looked up and stamped
+    CacheSection sections[CSCount];
+} CacheHeader;
+
+// Results of one source as compiled
+typedef struct CacheUnit
+{
+    const Interner*    interner;
+    const Arena*       strings;
+    const Ast*         ast;
+    const TextBuffer*  messages;
+    const CacheStamp*  stamps;
+    size_t             stampCount;
+    bool               succeeded;
+    bool               resolved;
+} CacheUnit;
+
+// A cache file mapped read only, valid until it is closed
+typedef struct CacheEntry
+{
+    Input              input;
+    const CacheHeader* header;
+} CacheEntry;
+
+// Hash of the source and the compiler version
+uint64_t cacheKey(const char* source, size_t size);
+
+// Maps the file of 'key' in 'directory', false if there is none or it does not fit the source
+bool openCacheEntry(CacheEntry* entry, const char* directory, uint64_t key, size_t sourceSize);
+
+void closeCacheEntry(CacheEntry* entry);
+
+const void* cacheSection(const CacheEntry* entry, CacheSectionKind kind, size_t* size);
+
+// The tree as stored, it must not be changed or finalized
+void viewCachedAst(const CacheEntry* entry, Ast* ast);
+
+// Text of a symbol of the cached source, NULL if there is no such symbol
+const char* cachedSymbol(const CacheEntry* entry, SymbolId symbol, unsigned* length);
+
+// Adds the symbols to an empty interner, so they get the ids the tokens and nodes refer to
+bool internCachedSymbols(const CacheEntry* entry, Interner* interner);
+
+// Writes a temporary file named after 'writer' and renames it, readers never see half a file
+bool storeCacheEntry(const char* directory, uint64_t key, size_t sourceSize, const CacheUnit* unit, unsigned writer);
+
+// Entries kept mapped from one file to the next, the slot of each key holds one at a time
+#define CACHE_SHELF_SLOTS 64
+
+typedef struct CacheShelf
+{
+    CacheEntry* entries;  // Allocated on the first use
+} CacheShelf;
+
+void initializeCacheShelf(CacheShelf* shelf);
+
+void finalizeCacheShelf(CacheShelf* shelf);
+
+// The entry of 'key', mapped again only if its slot held another one. Returns NULL if there is
+// none, the entry stays valid until the slot is taken or dropped.
+CacheEntry* shelveCacheEntry(CacheShelf* shelf, const char* directory, uint64_t key, size_t sourceSize);
+
+// Unmaps the entry of 'key' if it is kept, once it is stale or about to be stored again
+void dropCacheEntry(CacheShelf* shelf, uint64_t key);
+
+/*
+ * Helper
+ */
+
+// Writes 'size' bytes and pads them to eight, as mapped files align their sections
+bool writeAligned(FILE* file, const void* data, size_t size);
+
+// Puts a finished 'temporary' file in place of 'path'
+bool replaceFile(const char* temporary, const char* path);
+
+#endif  // HEADER_CACHE
@@ -0,0 +1,709 @@
+#include "driver.h"
+#include "cache.h"
+#include "interface.h"
+#include "../lexer/keywords.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define JOB_NONE SIZE_MAX
+
+/*
+ * Private helpers
+ */
+
+bool prepareWorkspace(Workspace* workspace)
+{
+    if(workspace->ready)
+    {
+        if(!clearInterner(&workspace->interner) || !clearAst(&workspace->ast))
+            return false;
+        resetParser(&workspace->parser, &workspace->ast);
+        resetArena(&workspace->stamps);
+        return true;
+    }
+
+    if(!initializeInterner(&workspace->interner))
+        return false;
+    if(!initializeAst(&workspace->ast))
+    {
+        finalizeInterner(&workspace->interner);
+        return false;
+    }
+    if(!initializeParser(&workspace->parser, &workspace->ast))
+    {
+        finalizeAst(&workspace->ast);
+        finalizeInterner(&workspace->interner);
+        return false;
+    }
+
+    initializeArena(&workspace->stamps, 0);
+    workspace->ready = true;
+    return true;
+}
+
+void finalizeWorkspace(Workspace* workspace)
+{
+    if(!workspace->ready)
+        return;
+
+    finalizeArena(&workspace->stamps);
+    finalizeParser(&workspace->parser);
+    finalizeAst(&workspace->ast);
+    finalizeInterner(&workspace->interner);
+    workspace->ready = false;
+}
+
+uint64_t sourceKey(CompileJob* job, const Lexer* lexer)
+{
+    if(!job->hashed)
+    {
+        job->key    = cacheKey(lexer->input.data, lexer->input.size);
+        job->hashed = true;
+    }
+    return job->key;
+}
+
+// Next name of a list with one name per line, NULL at its end
+const char* nextName(const TextBuffer* names, size_t* position, unsigned* length)
+{
+    if(*position >= names->size)
+        return NULL;
+
+    const char* name = names->text + *position;
+    const char* end  = memchr(name, '\n', names->size - *position);
+    *length          = (unsigned)(end - name);
+    *position += *length + 1;
+    return name;
+}
+
+int compareDependents(const void* left, const void* right)
+{
+    const Dependent* a = left;
+    const Dependent* b = right;
+    return a->priority < b->priority ? -1 : a->priority > b->priority;
+}
+
+/*
+ * Pre-scan
+ */
+
+// Lists the modules a source defines at the top level and the ones it uses from its tokens alone
+void scanTokens(Lexer* lexer, CompileJob* job)
+{
+    // The last four tokens, enough for 'name : Type = mod'
+    Lexeme recent[4] = {{.tok = TKEnd}, {.tok = TKEnd}, {.tok = TKEnd}, {.tok = TKEnd}};
+    size_t depth     = 0;
+
+    for(;;)
+    {
+        Token  tok    = tokenize(lexer);
+        Lexeme lexeme = currentLexeme(lexer);
+        if(tok == TKEnd || tok == TKInvalid)
+            break;
+
+        if(tok == TKKeyword && lexeme.value == KWMod && depth == 0 && recent[3].tok == TKAssignment)
+        {
+            const Lexeme* name = recent[2].tok == TKIdentifier ? &recent[2] : &recent[0];
+            if(recent[2].tok == TKIdentifier || (recent[2].tok == TKType && recent[1].tok == TKColonSeparator &&
+                                                 recent[0].tok == TKIdentifier))
+                appendText(&job->defines, "%.*s\n", name->length, name->text);
+        }
+        else if(tok == TKIdentifier && recent[3].tok == TKKeyword && recent[3].value == KWUse)
+            appendText(&job->uses, "%.*s\n", lexeme.length, lexeme.text);
+
+        // Blocks end with 'end', elif and else stay in theirs
+        if(tok == TKKeyword && (lexeme.value == KWDat || lexeme.value == KWFun || lexeme.value == KWIf ||
+                                lexeme.value == KWFor || lexeme.value == KWWhile || lexeme.value == KWMod))
+            depth++;
+        else if(tok == TKKeyword && lexeme.value == KWEnd && depth > 0)
+            depth--;
+
+        recent[0] = recent[1];
+        recent[1] = recent[2];
+        recent[2] = recent[3];
+        recent[3] = lexeme;
+    }
+}
+
+// The same from a cached tree, false if its uses were not stamped
+bool scanCached(const CacheEntry* entry, CompileJob* job)
+{
+    if(!entry->header->resolved)
+        return false;
+
+    Ast ast;
+    viewCachedAst(entry, &ast);
+    for(NodeIndex index = nodeAt(&ast, ast.root)->first; index != NODE_NONE; index = nodeAt(&ast, index)->next)
+    {
+        const Node* node = nodeAt(&ast, index);
+        unsigned    length;
+        const char* name = cachedSymbol(entry, node->name, &length);
+        if(node->kind == NDAssignment && node->first != NODE_NONE && nodeAt(&ast, node->first)->kind == NDMod &&
+           name != NULL)
+            appendText(&job->defines, "%.*s\n", length, name);
+    }
+
+    size_t            size;
+    const CacheStamp* stamps = cacheSection(entry, CSStamps, &size);
+    for(size_t i = 0; i < size / sizeof(CacheStamp); ++i)
+    {
+        unsigned    length;
+        const char* name = cachedSymbol(entry, stamps[i].name, &length);
+        if(name != NULL)
+            appendText(&job->uses, "%.*s\n", length, name);
+    }
+    return true;
+}
+
+void scanJob(void* context, size_t task, unsigned worker)
+{
+    Driver*     driver    = context;
+    CompileJob* job       = &driver->jobs[task];
+    Workspace*  workspace = &driver->workspaces[worker];
+
+    // Streams can only be read once, by the compile, and files that do not open fail there
+    Lexer      lexer;
+    Diagnostic diagnostic = {.set = false};
+    if(!prepareWorkspace(workspace))
+        return;
+    if(!initializeLexer(&lexer, job->filename, &workspace->interner) || lexer.input.mode != InputMapped)
+    {
+        finalizeLexer(&lexer);
+        return;
+    }
+
+    lexer.deferred = &diagnostic;
+    job->cost      = lexer.input.size + 1;
+
+    // The entry stays on the shelf for the compile
+    CacheEntry* entry = driver->cache != NULL ? shelveCacheEntry(&workspace->shelf, driver->cache, sourceKey(job, &lexer),
+                                                                 lexer.input.size)
+                                              : NULL;
+    if(entry != NULL && scanCached(entry, job))
+    {
+        job->cost = 1;
+        finalizeLexer(&lexer);
+        return;
+    }
+
+    scanTokens(&lexer, job);
+    finalizeLexer(&lexer);
+}
+
+/*
+ * Module graph
+ */
+
+// Links each job to the jobs using its modules and ranks them by the longest chain of work they start
+bool buildGraph(Driver* driver)
+{
+    Interner names;
+    if(!initializeInterner(&names))
+        return false;
+
+    size_t*   definers = NULL;
+    size_t*   order    = malloc(driver->count * sizeof(size_t));
+    size_t*   degrees  = malloc(driver->count * sizeof(size_t));
+    SymbolId  defined  = 0;
+    size_t    edges    = 0;
+    bool      built    = order != NULL && degrees != NULL;
+
+    // The first job defining a module is the one using it waits for
+    for(size_t i = 0; i < driver->count && built; ++i)
+    {
+        size_t      position = 0;
+        unsigned    length;
+        const char* name;
+        while((name = nextName(&driver->jobs[i].defines, &position, &length)) != NULL && built)
+        {
+            SymbolId symbol = intern(&names, name, length);
+            if(symbol >= defined)
+            {
+                size_t* grown = realloc(definers, (symbol + 1) * sizeof(size_t));
+                built         = grown != NULL && symbol != SYMBOL_NONE;
+                if(!built)
+                    break;
+
+                definers = grown;
+                for(; defined <= symbol; ++defined)
+                    definers[defined] = JOB_NONE;
+            }
+            if(definers[symbol] == JOB_NONE)
+                definers[symbol] = i;
+        }
+    }
+
+    // Counted first, then placed in the ranges of their jobs
+    for(int pass = 0; pass < 2 && built; ++pass)
+    {
+        if(pass == 1)
+        {
+            driver->dependents = malloc((edges + 1) * sizeof(Dependent));
+            built              = driver->dependents != NULL;
+            for(size_t i = 0, first = 0; i < driver->count; ++i)
+            {
+                driver->jobs[i].firstDependent = first;
+                first += driver->jobs[i].dependentCount;
+                driver->jobs[i].dependentCount = 0;
+            }
+        }
+
+        for(size_t i = 0; i < driver->count && built; ++i)
+        {
+            size_t      position = 0;
+            unsigned    length;
+            const char* name;
+            while((name = nextName(&driver->jobs[i].uses, &position, &length)) != NULL)
+            {
+                SymbolId symbol = intern(&names, name, length);
+                size_t   job    = symbol < defined ? definers[symbol] : JOB_NONE;
+                if(job == JOB_NONE || job == i)
+                    continue;
+
+                CompileJob* definer = &driver->jobs[job];
+                if(pass == 1)
+                {
+                    driver->dependents[definer->firstDependent + definer->dependentCount].job = i;
+                    atomic_fetch_add_explicit(&driver->jobs[i].waiting, 1, memory_order_relaxed);
+                }
+                definer->dependentCount++;
+                edges++;
+            }
+        }
+    }
+
+    // Jobs in topological order, the ones left over are in or behind a cycle. Whether their
+    // uses resolve would depend on which one runs first, so they fail without compiling.
+    // They keep waiting for each other and are never pushed.
+    size_t ordered = 0;
+    for(size_t i = 0; i < driver->count && built; ++i)
+    {
+        degrees[i] = atomic_load_explicit(&driver->jobs[i].waiting, memory_order_relaxed);
+        if(degrees[i] == 0)
+            order[ordered++] = i;
+    }
+    for(size_t next = 0; next < ordered && built; ++next)
+    {
+        const CompileJob* job = &driver->jobs[order[next]];
+        for(size_t i = job->firstDependent; i < job->firstDependent + job->dependentCount; ++i)
+            if(--degrees[driver->dependents[i].job] == 0)
+                order[ordered++] = driver->dependents[i].job;
+    }
+
+    for(size_t i = 0; i < driver->count && built; ++i)
+    {
+        driver->jobs[i].priority = driver->jobs[i].cost;
+        driver->jobs[i].cyclic   = degrees[i] > 0;
+    }
+
+    // From the last job on, each one adds its cost to the dearest chain behind it
+    for(size_t next = ordered; next > 0 && built; --next)
+    {
+        CompileJob* job     = &driver->jobs[order[next - 1]];
+        uint64_t    longest = 0;
+        for(size_t i = job->firstDependent; i < job->firstDependent + job->dependentCount; ++i)
+        {
+            const CompileJob* dependent  = &driver->jobs[driver->dependents[i].job];
+            driver->dependents[i].priority = dependent->priority;
+            if(!dependent->cyclic && dependent->priority > longest)
+                longest = dependent->priority;
+        }
+
+        job->priority = job->cost + longest;
+        qsort(driver->dependents + job->firstDependent, job->dependentCount, sizeof(Dependent), compareDependents);
+    }
+
+    free(order);
+    free(degrees);
+    free(definers);
+    finalizeInterner(&names);
+    return built;
+}
+
+/*
+ * Compiling
+ */
+
+// Takes the diagnostics and symbols of a file compiled before, its tree stays
+// in the cache. Returns the entry it was loaded from, NULL if there is none.
+CacheEntry* loadCached(Driver* driver, CompileJob* job, Workspace* workspace, size_t size)
+{
+    CacheEntry* entry = shelveCacheEntry(&workspace->shelf, driver->cache, job->key, size);
+    if(entry == NULL)
+        return NULL;
+
+    // Results depend on the interfaces of the modules used, they must be the ones stamped
+    const CacheHeader* header  = entry->header;
+    bool               current = !header->succeeded || (header->resolved != 0) == (driver->modules != NULL);
+
+    size_t            stampsSize;
+    const CacheStamp* stamps = cacheSection(entry, CSStamps, &stampsSize);
+    for(size_t i = 0; i < stampsSize / sizeof(CacheStamp) && current; ++i)
+    {
+        unsigned         length;
+        const char*      name   = cachedSymbol(entry, stamps[i].name, &length);
+        const Interface* module = name != NULL ? useInterface(&workspace->interfaces, name, length) : NULL;
+        current                 = name != NULL && (module != NULL ? module->header->hash : 0) == stamps[i].hash;
+    }
+
+    // A file that does not fit leaves the symbols it added, they are dropped again
+    if(current && internCachedSymbols(entry, &workspace->interner))
+    {
+        size_t      length;
+        const char* messages = cacheSection(entry, CSMessages, &length);
+        if(length > 0)
+            appendText(&job->messages, "%.*s", (int)length, messages);
+        job->succeeded = header->succeeded != 0;
+        return entry;
+    }
+
+    clearInterner(&workspace->interner);
+    dropCacheEntry(&workspace->shelf, job->key);
+    return NULL;
+}
+
+// Writes the interfaces of the named modules at the top level of the mapped 'input'
+void exportModules(Driver* driver, CompileJob* job, const Input* input, const Ast* ast, const Interner* interner, unsigned worker)
+{
+    // Recorded so interfaces are dropped once their source is gone or changed
+    char source[INPUT_PATH_SIZE];
+    bool resolved = absoluteInputPath(job->filename, source);
+
+    for(NodeIndex index = nodeAt(ast, ast->root)->first; index != NODE_NONE; index = nodeAt(ast, index)->next)
+    {
+        const Node* node = nodeAt(ast, index);
+        if(node->kind != NDAssignment || node->first == NODE_NONE || nodeAt(ast, node->first)->kind != NDMod ||
+           (resolved && writeInterface(driver->modules, ast, index, interner, job->key, source, &input->stamp, worker)))
+            continue;
+
+        unsigned    length;
+        const char* name = symbolText(interner, node->name, &length);
+        appendText(&job->messages, "Could not write the interface of '%.*s'\n", length, name);
+    }
+}
+
+// Whether a named module at the top level is called 'name'
+bool definesModule(const Ast* ast, SymbolId name)
+{
+    for(NodeIndex index = nodeAt(ast, ast->root)->first; index != NODE_NONE; index = nodeAt(ast, index)->next)
+    {
+        const Node* node = nodeAt(ast, index);
+        if(node->kind == NDAssignment && node->name == name && node->first != NODE_NONE &&
+           nodeAt(ast, node->first)->kind == NDMod)
+            return true;
+    }
+    return false;
+}
+
+// Reports uses of modules without an interface and stamps the interfaces used. Modules
+// of the file itself need none, its interfaces are only written once its uses resolve.
+// Returns false if a stamp is missing.
+bool resolveUses(CompileJob* job, Lexer* lexer, const Ast* ast, const Interner* interner, InterfaceTable* interfaces, Arena* stamps)
+{
+    bool stamped = true;
+    for(NodeIndex index = 1; index < nodeCount(ast); ++index)
+    {
+        const Node* node = nodeAt(ast, index);
+        if(node->kind != NDUse || definesModule(ast, node->name))
+            continue;
+
+        unsigned         length;
+        const char*      name   = symbolText(interner, node->name, &length);
+        const Interface* module = useInterface(interfaces, name, length);
+
+        size_t offset = allocateArena(stamps, sizeof(CacheStamp), sizeof(uint64_t));
+        if(offset != ARENA_FAILED)
+        {
+            CacheStamp* stamp = arenaAt(stamps, offset);
+            stamp->name       = node->name;
+            stamp->unused     = 0;
+            stamp->hash       = module != NULL ? module->header->hash : 0;
+        }
+        else
+            stamped = false;
+
+        if(module != NULL)
+            continue;
+
+        char source[INPUT_PATH_SIZE];
+        if(interfaceSource(interfaces, name, length, source, sizeof(source)))
+            sourceErrorAt(lexer, node->offset, "Module '%.*s' is out of date with '%s'", length, name, source);
+        else
+            sourceErrorAt(lexer, node->offset, "Unknown module '%.*s'", length, name);
+        job->succeeded = false;
+    }
+    return stamped;
+}
+
+void compileFile(Driver* driver, CompileJob* job, Workspace* workspace, unsigned worker)
+{
+    if(!prepareWorkspace(workspace))
+    {
+        appendText(&job->messages, "Out of memory\n");
+        return;
+    }
+
+    Lexer lexer;
+    bool  opened   = initializeLexer(&lexer, job->filename, &workspace->interner);
+    lexer.messages = &job->messages;
+    if(!opened)
+    {
+        appendText(&job->messages, "Could not open '%s'\n", job->filename);
+        finalizeLexer(&lexer);
+        return;
+    }
+
+    // Only mapped files are cached and export modules, a hit costs a hash of the file and a mapping
+    bool mapped = lexer.input.mode == InputMapped;
+    bool cached = driver->cache != NULL && mapped;
+    if(mapped && (cached || driver->modules != NULL))
+        sourceKey(job, &lexer);
+
+    CacheEntry* entry = cached ? loadCached(driver, job, workspace, lexer.input.size) : NULL;
+    if(entry != NULL)
+    {
+        Ast ast;
+        viewCachedAst(entry, &ast);
+        if(driver->modules != NULL && job->succeeded)
+            exportModules(driver, job, &lexer.input, &ast, &workspace->interner, worker);
+        finalizeLexer(&lexer);
+        return;
+    }
+
+    Lexeme       lexeme;
+    TokenRing    tokens;
+    TokenStream  stream;
+    StreamReader reader = {&stream, 0};
+
+    if(mapped && !tokenizeAll(&lexer, &stream) && stream.count == 0)
+    {
+        // Reported already, there is nothing to parse
+        finalizeTokenStream(&stream);
+        finalizeLexer(&lexer);
+        return;
+    }
+    if(mapped)
+        initializeTokenRing(&tokens, streamSource, &reader);
+    else
+    {
+        initializeTokenStream(&stream, NULL, 0);
+        initializeTokenRing(&tokens, lexerSource, &lexer);
+    }
+
+    do
+        lexeme = *peekToken(&tokens, 0);
+    while(parse(&workspace->parser, &tokens));
+
+    job->succeeded = workspace->parser.state != ASTInvalid;
+    if(!job->succeeded)
+        lexErrorAt(&lexer, &lexeme, "Invalid syntax at '%.*s'", lexeme.length, lexeme.text);
+
+    // A file that uses modules it can not find publishes none of its own
+    bool resolved = driver->modules != NULL && job->succeeded;
+    bool stamped  = true;
+    if(resolved)
+        stamped = resolveUses(job, &lexer, &workspace->ast, &workspace->interner, &workspace->interfaces, &workspace->stamps);
+    if(resolved && mapped && job->succeeded)
+        exportModules(driver, job, &lexer.input, &workspace->ast, &workspace->interner, worker);
+
+    if(cached && stamped)
+    {
+        CacheUnit unit;
+        unit.interner   = &workspace->interner;
+        unit.strings    = &lexer.strings;
+        unit.ast        = &workspace->ast;
+        unit.messages   = &job->messages;
+        unit.stamps     = (const CacheStamp*)workspace->stamps.data;
+        unit.stampCount = workspace->stamps.size / sizeof(CacheStamp);
+        unit.succeeded  = job->succeeded;
+        unit.resolved   = resolved;
+        dropCacheEntry(&workspace->shelf, job->key);
+        storeCacheEntry(driver->cache, job->key, lexer.input.size, &unit, worker);
+    }
+
+    finalizeTokenStream(&stream);
+    finalizeLexer(&lexer);
+}
+
+void compileJob(void* context, size_t task, unsigned worker)
+{
+    Driver*     driver    = context;
+    CompileJob* job       = &driver->jobs[task];
+    Workspace*  workspace = &driver->workspaces[worker];
+
+    // Interfaces mapped for earlier files are checked once before this one uses them
+    recheckInterfaces(&workspace->interfaces);
+    compileFile(driver, job, workspace, worker);
+
+    // Dependents are pushed by ascending priority, so this worker takes the dearest first
+    for(size_t i = job->firstDependent; i < job->firstDependent + job->dependentCount; ++i)
+    {
+        size_t      next      = driver->dependents[i].job;
+        CompileJob* dependent = &driver->jobs[next];
+        if(!dependent->cyclic && atomic_fetch_sub_explicit(&dependent->waiting, 1, memory_order_acq_rel) == 1)
+            pushTask(&driver->pool, worker, next);
+    }
+}
+
+/*
+ * Driver
+ */
+
+
+bool initializeDriver(Driver* driver, unsigned threads, const char* cache, const char* modules)
+{
+    driver->jobs       = NULL;
+    driver->count      = 0;
+    driver->dependents = NULL;
+    driver->cache      = cache;
+    driver->modules    = modules;
+    driver->workspaces = calloc(threads > 0 ? threads : 1, sizeof(Workspace));
+    if(driver->workspaces == NULL)
+        return false;
+
+    if(!initializeThreadPool(&driver->pool, threads, 0, compileJob, driver))
+    {
+        free(driver->workspaces);
+        return false;
+    }
+
+    for(unsigned i = 0; i < driver->pool.count; ++i)
+    {
+        initializeInterfaceTable(&driver->workspaces[i].interfaces, modules);
+        initializeCacheShelf(&driver->workspaces[i].shelf);
+    }
+    return true;
+}
+
+void finalizeDriver(Driver* driver)
+{
+    for(unsigned i = 0; i < driver->pool.count; ++i)
+    {
+        finalizeInterfaceTable(&driver->workspaces[i].interfaces);
+        finalizeCacheShelf(&driver->workspaces[i].shelf);
+        finalizeWorkspace(&driver->workspaces[i]);
+    }
+
+    finalizeThreadPool(&driver->pool);
+    free(driver->workspaces);
+    driver->workspaces = NULL;
+}
+
+size_t runDriver(Driver* driver, const char* const* filenames, size_t count, TextBuffer* output)
+{
+    if(count == 0)
+        return 0;
+
+    driver->count      = count;
+    driver->dependents = NULL;
+    driver->jobs       = calloc(count, sizeof(CompileJob));
+    Dependent* ready   = malloc(count * sizeof(Dependent));
+
+    if(driver->jobs == NULL || ready == NULL || !reserveThreadPool(&driver->pool, count))
+    {
+        appendText(output, "Out of memory\n");
+        free(ready);
+        free(driver->jobs);
+        driver->jobs = NULL;
+        return count;
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        CompileJob* job = &driver->jobs[i];
+        job->filename   = filenames[i];
+        initializeTextBuffer(&job->messages);
+        initializeTextBuffer(&job->defines);
+        initializeTextBuffer(&job->uses);
+        atomic_init(&job->waiting, 0);
+    }
+
+    // Modules order the files, which the pre-scan finds out on the same workers
+    if(driver->modules != NULL)
+    {
+        driver->pool.run = scanJob;
+        for(size_t i = 0; i < count; ++i)
+            pushTask(&driver->pool, (unsigned)(i % driver->pool.count), i);
+        runThreadPool(&driver->pool);
+
+        if(!buildGraph(driver))
+        {
+            appendText(output, "Out of memory\n");
+            for(size_t i = 0; i < count; ++i)
+            {
+                driver->jobs[i].dependentCount = 0;
+                atomic_store_explicit(&driver->jobs[i].waiting, 0, memory_order_relaxed);
+            }
+        }
+    }
+
+    // Files waiting for nothing are dealt out in turn by ascending priority, workers take
+    // their dearest first and steal the cheapest of others
+    size_t readyCount = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(atomic_load_explicit(&driver->jobs[i].waiting, memory_order_relaxed) > 0)
+            continue;
+        ready[readyCount].priority = driver->jobs[i].priority;
+        ready[readyCount].job      = i;
+        readyCount++;
+    }
+    qsort(ready, readyCount, sizeof(Dependent), compareDependents);
+
+    driver->pool.run = compileJob;
+    for(size_t i = 0; i < readyCount; ++i)
+        pushTask(&driver->pool, (unsigned)(i % driver->pool.count), ready[i].job);
+
+    runThreadPool(&driver->pool);
+
+    size_t failed = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        CompileJob* job = &driver->jobs[i];
+        if(!job->succeeded)
+            failed++;
+        if(job->messages.size > 0 || job->cyclic)
+            appendText(output, "%s:\n", job->filename);
+        if(job->cyclic)
+            appendText(output, "Depends on modules using each other in a cycle, not compiled\n");
+        if(job->messages.size > 0)
+            appendText(output, "%s", job->messages.text);
+        finalizeTextBuffer(&job->messages);
+        finalizeTextBuffer(&job->defines);
+        finalizeTextBuffer(&job->uses);
+    }
+
+    free(ready);
+    free(driver->dependents);
+    free(driver->jobs);
+    driver->dependents = NULL;
+    driver->jobs       = NULL;
+    return failed;
+}
+
+size_t compileFiles(const char* const* filenames, size_t count, unsigned threads, const char* cache, const char* modules)
+{
+    if(count == 0)
+        return 0;
+    if(threads == 0)
+        threads = 1;
+    if(threads > count)
+        threads = (unsigned)count;
+
+    Driver driver;
+    if(!initializeDriver(&driver, threads, cache, modules))
+    {
+        printf("Out of memory\n");
+        return count;
+    }
+
+    TextBuffer output;
+    initializeTextBuffer(&output);
+    size_t failed = runDriver(&driver, filenames, count, &output);
+    if(output.size > 0)
+        fputs(output.text, stdout);
+
+    finalizeTextBuffer(&output);
+    finalizeDriver(&driver);
+    return failed;
+}
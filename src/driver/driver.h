@@ -0,0 +1,82 @@
+#ifndef HEADER_DRIVER
+#define HEADER_DRIVER
+
+#include "cache.h"
+#include "interface.h"
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../util/pool.h"
+#include "../util/text.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Driver
+ */
+
+// One input file, its diagnostics are printed once all files are done
+typedef struct CompileJob
+{
+    const char*   filename;
+    TextBuffer    messages;
+    bool          succeeded;
+    uint64_t      key;       // Cache key of the source, once it was hashed
+    bool          hashed;
+    TextBuffer    defines;   // Names of the modules it defines, one per line
+    TextBuffer    uses;      // Names of the modules it uses, one per line
+    uint64_t      cost;      // Bytes to compile, 1 if the cache has them
+    uint64_t      priority;  // Cost of the longest chain of jobs starting with this one
+    size_t        firstDependent;
+    size_t        dependentCount;
+    atomic_size_t waiting;  // Jobs defining modules it uses that are not done yet
+    bool          cyclic;   // In or behind modules using each other in a cycle, it fails uncompiled
+} CompileJob;
+
+// Job using the modules of another one
+typedef struct Dependent
+{
+    uint64_t priority;
+    size_t   job;
+} Dependent;
+
+// State of one worker, reused by all jobs it runs so nothing is shared
+typedef struct Workspace
+{
+    Interner interner;
+    Ast      ast;
+    Parser   parser;
+    Arena          stamps;      // CacheStamp of each use
+    InterfaceTable interfaces;  // Kept mapped from one source to the next
+    CacheShelf     shelf;
+    bool           ready;
+} Workspace;
+
+typedef struct Driver
+{
+    CompileJob* jobs;
+    size_t      count;
+    Dependent*  dependents;  // Of each job in turn, by ascending priority
+    Workspace*  workspaces;  // One per worker
+    ThreadPool  pool;
+    const char* cache;    // Directory of the compile cache, NULL without
+    const char* modules;  // Directory of the module interfaces, NULL without
+} Driver;
+
+// Files found in the 'cache' directory are not compiled again, NULL disables the cache.
+// Named modules are written to interfaces in 'modules', where 'use' looks them up.
+// The workers keep their tables, interfaces and cache entries from one run to the next.
+bool initializeDriver(Driver* driver, unsigned threads, const char* cache, const char* modules);
+
+void finalizeDriver(Driver* driver);
+
+// Lexes and parses 'count' files and appends the diagnostics to 'output' in the order of the files.
+// Returns the number of files that failed. With modules a pre-scan orders the files
+// so each one is compiled after the modules it uses.
+size_t runDriver(Driver* driver, const char* const* filenames, size_t count, TextBuffer* output);
+
+// Runs a driver of 'threads' workers once and prints the diagnostics
+size_t compileFiles(const char* const* filenames, size_t count, unsigned threads, const char* cache, const char* modules);
+
+#endif  // HEADER_DRIVER
@@ -0,0 +1,458 @@
+#include "interface.h"
+#include "cache.h"
+#include "../util/hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERFACE_PATH_SIZE 4096
+
+// Initial capacity of the stack of nested modules, doubles when full
+#define INTERFACE_STACK_SIZE 64
+
+// Entries and text of an interface being written
+typedef struct InterfaceBuilder
+{
+    const Ast*      ast;
+    const Interner* interner;
+    Arena           entries;
+    Arena           text;
+    uint32_t        count;
+    bool            failed;
+} InterfaceBuilder;
+
+// Top entry while the exports are sorted
+typedef struct ExportName
+{
+    const char* name;
+    uint32_t    length;
+    uint32_t    entry;
+} ExportName;
+
+// Statements left in a module whose nested module is being exported
+typedef struct ExportLevel
+{
+    NodeIndex next;
+    uint32_t  parent;
+} ExportLevel;
+
+/*
+ * Private helpers
+ */
+
+bool interfacePath(char* path, const char* directory, const char* name, size_t length, const char* suffix)
+{
+    int written = snprintf(path, INTERFACE_PATH_SIZE, "%s/%.*s%s", directory, (int)length, name, suffix);
+    return written > 0 && written < INTERFACE_PATH_SIZE;
+}
+
+int compareNames(const char* name, size_t length, const char* other, size_t otherLength)
+{
+    int order = memcmp(name, other, length < otherLength ? length : otherLength);
+    if(order != 0)
+        return order;
+    return length < otherLength ? -1 : length > otherLength;
+}
+
+int compareExports(const void* left, const void* right)
+{
+    const ExportName* a = left;
+    const ExportName* b = right;
+    return compareNames(a->name, a->length, b->name, b->length);
+}
+
+// Returns the offset of the zero terminated copy in the text
+uint32_t addText(InterfaceBuilder* builder, const char* text, uint32_t length)
+{
+    size_t offset = allocateArena(&builder->text, length + 1, 1);
+    if(offset == ARENA_FAILED)
+    {
+        builder->failed = true;
+        return 0;
+    }
+
+    memcpy(arenaAt(&builder->text, offset), text, length);
+    ((char*)arenaAt(&builder->text, offset))[length] = '\0';
+    return (uint32_t)offset;
+}
+
+uint32_t addName(InterfaceBuilder* builder, SymbolId symbol, uint32_t* length)
+{
+    const char* name = symbolText(builder->interner, symbol, (unsigned*)length);
+    return addText(builder, name, *length);
+}
+
+uint32_t addEntry(InterfaceBuilder* builder, NodeKind kind, const Node* node, uint32_t parent)
+{
+    size_t offset = allocateArena(&builder->entries, sizeof(InterfaceEntry), sizeof(uint32_t));
+    if(offset == ARENA_FAILED)
+    {
+        builder->failed = true;
+        return INTERFACE_NONE;
+    }
+
+    InterfaceEntry* entry = arenaAt(&builder->entries, offset);
+    entry->kind           = (uint8_t)kind;
+    entry->type           = node->type;
+    entry->unused         = 0;
+    entry->parent         = parent;
+    entry->name           = addName(builder, node->name, &entry->length);
+    return builder->count++;
+}
+
+// Adds the children of kind 'kind' as parts of 'parent'
+void exportParts(InterfaceBuilder* builder, NodeIndex first, NodeKind kind, uint32_t parent)
+{
+    for(NodeIndex index = first; index != NODE_NONE; index = nodeAt(builder->ast, index)->next)
+    {
+        const Node* node = nodeAt(builder->ast, index);
+        if(node->kind == kind)
+            addEntry(builder, kind, node, parent);
+    }
+}
+
+// Names declared by the statements of a module, control flow declares nothing outside.
+// Nested modules are walked on a stack, so their depth is only limited by memory.
+void exportStatements(InterfaceBuilder* builder, NodeIndex first, uint32_t parent)
+{
+    size_t       capacity = INTERFACE_STACK_SIZE;
+    size_t       depth    = 0;
+    ExportLevel* levels   = malloc(capacity * sizeof(ExportLevel));
+    if(levels == NULL)
+    {
+        builder->failed = true;
+        return;
+    }
+
+    levels[0].next   = first;
+    levels[0].parent = parent;
+    while(!builder->failed)
+    {
+        NodeIndex index = levels[depth].next;
+        if(index == NODE_NONE)
+        {
+            if(depth == 0)
+                break;
+
+            depth -= 1;
+            continue;
+        }
+
+        const Node* node  = nodeAt(builder->ast, index);
+        const Node* value = node->first != NODE_NONE ? nodeAt(builder->ast, node->first) : NULL;
+        uint32_t    entry;
+
+        levels[depth].next = node->next;
+        parent             = levels[depth].parent;
+        if(node->kind == NDAssignment && value != NULL && value->kind == NDFun)
+        {
+            entry = addEntry(builder, NDFun, node, parent);
+            exportParts(builder, value->first, NDParameter, entry);
+        }
+        else if(node->kind == NDAssignment && value != NULL && value->kind == NDMod)
+        {
+            entry = addEntry(builder, NDMod, node, parent);
+            if(depth + 1 == capacity)
+            {
+                ExportLevel* grown = realloc(levels, capacity * 2 * sizeof(ExportLevel));
+                if(grown == NULL)
+                {
+                    builder->failed = true;
+                    break;
+                }
+
+                levels = grown;
+                capacity *= 2;
+            }
+
+            // Its statements come next, the rest of this module after them
+            depth += 1;
+            levels[depth].next   = value->first;
+            levels[depth].parent = entry;
+        }
+        else if(node->kind == NDAssignment)
+            addEntry(builder, NDAssignment, node, parent);
+        else if(node->kind == NDDat)
+        {
+            entry = addEntry(builder, NDDat, node, parent);
+            exportParts(builder, node->first, NDField, entry);
+        }
+        else if(node->kind == NDFun && node->name != SYMBOL_NONE)
+        {
+            entry = addEntry(builder, NDFun, node, parent);
+            exportParts(builder, node->first, NDParameter, entry);
+        }
+    }
+
+    free(levels);
+}
+
+bool writeBuilder(InterfaceBuilder* builder, const char* path, InterfaceHeader* header, const char* temporary)
+{
+    // Top entries sorted by name for lookups
+    const InterfaceEntry* entries = (const InterfaceEntry*)builder->entries.data;
+    ExportName*           names   = malloc((builder->count + 1) * sizeof(ExportName));
+    uint32_t*             exports = malloc((builder->count + 1) * sizeof(uint32_t));
+    bool                  written = false;
+
+    if(names != NULL && exports != NULL)
+    {
+        uint32_t count = 0;
+        for(uint32_t i = 0; i < builder->count; ++i)
+        {
+            if(entries[i].parent != INTERFACE_NONE)
+                continue;
+            names[count].name   = builder->text.data + entries[i].name;
+            names[count].length = entries[i].length;
+            names[count].entry  = i;
+            count++;
+        }
+
+        qsort(names, count, sizeof(ExportName), compareExports);
+        for(uint32_t i = 0; i < count; ++i)
+            exports[i] = names[i].entry;
+
+        header->entryCount  = builder->count;
+        header->exportCount = count;
+        header->textSize    = (uint32_t)builder->text.size;
+        header->hash        = hashBytes(entries, builder->count * sizeof(InterfaceEntry), INTERFACE_VERSION);
+        header->hash        = hashBytes(exports, count * sizeof(uint32_t), header->hash);
+        header->hash        = hashBytes(builder->text.data, builder->text.size, header->hash);
+
+        FILE* file = fopen(temporary, "wb");
+        if(file != NULL)
+        {
+            written = writeAligned(file, header, sizeof(InterfaceHeader)) &&
+                      writeAligned(file, entries, builder->count * sizeof(InterfaceEntry)) &&
+                      writeAligned(file, exports, count * sizeof(uint32_t)) &&
+                      writeAligned(file, builder->text.data, builder->text.size);
+            if(fclose(file) != 0 || !written)
+            {
+                remove(temporary);
+                written = false;
+            }
+            else
+                written = replaceFile(temporary, path);
+        }
+    }
+
+    free(names);
+    free(exports);
+    return written;
+}
+
+// Whether the file still holds the interface that is mapped, without mapping it
+bool interfaceCurrent(const Interface* module, const char* directory)
+{
+    char                   path[INTERFACE_PATH_SIZE];
+    const InterfaceHeader* header = module->header;
+    InterfaceHeader        stored;
+    FILE*                  file = interfacePath(path, directory, module->text + header->name, header->length, ".dudei")
+                                      ? fopen(path, "rb")
+                                      : NULL;
+    if(file == NULL)
+        return false;
+
+    bool read = fread(&stored, sizeof(stored), 1, file) == 1;
+    fclose(file);
+    return read && stored.magic == header->magic && stored.version == header->version && stored.key == header->key &&
+           stored.hash == header->hash && stored.sourceSize == header->sourceSize &&
+           stored.sourceModified == header->sourceModified;
+}
+
+// Whether the source the interface was written from is still there unchanged
+bool sourceCurrent(const Interface* module)
+{
+    InputStamp stamp;
+    return stampInput(module->text + module->header->source, &stamp) && stamp.size == module->header->sourceSize &&
+           stamp.modified == module->header->sourceModified;
+}
+
+/*
+ * Module interfaces
+ */
+
+bool writeInterface(const char* directory, const Ast* ast, NodeIndex assignment, const Interner* interner, uint64_t key,
+                    const char* source, const InputStamp* stamp, unsigned writer)
+{
+    const Node* node = nodeAt(ast, assignment);
+    unsigned    length;
+    const char* name = symbolText(interner, node->name, &length);
+
+    // Nothing changed since the interface was written
+    Interface existing;
+    if(openInterface(&existing, directory, name, length))
+    {
+        bool current = existing.header->key == key && existing.header->sourceSize == stamp->size &&
+                       existing.header->sourceModified == stamp->modified &&
+                       strcmp(existing.text + existing.header->source, source) == 0;
+        closeInterface(&existing);
+        if(current)
+            return true;
+    }
+
+    char path[INTERFACE_PATH_SIZE];
+    char temporary[INTERFACE_PATH_SIZE];
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%u.tmp", writer);
+    if(!interfacePath(path, directory, name, length, ".dudei") || !interfacePath(temporary, directory, name, length, suffix))
+        return false;
+
+    InterfaceBuilder builder;
+    builder.ast      = ast;
+    builder.interner = interner;
+    builder.count    = 0;
+    builder.failed   = false;
+    initializeArena(&builder.entries, 64 * sizeof(InterfaceEntry));
+    initializeArena(&builder.text, 1024);
+
+    InterfaceHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic          = INTERFACE_MAGIC;
+    header.version        = INTERFACE_VERSION;
+    header.key            = key;
+    header.sourceSize     = stamp->size;
+    header.sourceModified = stamp->modified;
+    header.name           = addName(&builder, node->name, &header.length);
+    header.sourceLength   = (uint32_t)strlen(source);
+    header.source         = addText(&builder, source, header.sourceLength);
+    exportStatements(&builder, nodeAt(ast, node->first)->first, INTERFACE_NONE);
+
+    bool written = !builder.failed && writeBuilder(&builder, path, &header, temporary);
+    finalizeArena(&builder.entries);
+    finalizeArena(&builder.text);
+    return written;
+}
+
+bool openInterface(Interface* module, const char* directory, const char* name, size_t length)
+{
+    char path[INTERFACE_PATH_SIZE];
+    module->header = NULL;
+    if(!interfacePath(path, directory, name, length, ".dudei") || !openInput(&module->input, path))
+        return false;
+
+    const char*            data   = module->input.data;
+    const InterfaceHeader* header = (const InterfaceHeader*)data;
+    size_t                 size   = module->input.size;
+    if(module->input.mode != InputMapped || size < sizeof(InterfaceHeader) || header->magic != INTERFACE_MAGIC ||
+       header->version != INTERFACE_VERSION)
+    {
+        closeInterface(module);
+        return false;
+    }
+
+    size_t entries = sizeof(InterfaceHeader);
+    size_t exports = entries + (size_t)header->entryCount * sizeof(InterfaceEntry);
+    size_t text    = exports + (((size_t)header->exportCount * sizeof(uint32_t) + 7) & ~(size_t)7);
+    if(text > size || header->textSize > size - text || header->exportCount > header->entryCount)
+    {
+        closeInterface(module);
+        return false;
+    }
+
+    module->header  = header;
+    module->entries = (const InterfaceEntry*)(data + entries);
+    module->exports = (const uint32_t*)(data + exports);
+    module->text    = data + text;
+
+    // Names and links are checked once, lookups trust them
+    bool valid = header->name < header->textSize && header->length < header->textSize - header->name &&
+                 header->source < header->textSize && header->sourceLength < header->textSize - header->source &&
+                 module->text[header->source + header->sourceLength] == '\0';
+    for(uint32_t i = 0; i < header->entryCount && valid; ++i)
+    {
+        const InterfaceEntry* entry = &module->entries[i];
+        valid = entry->name < header->textSize && entry->length < header->textSize - entry->name &&
+                (entry->parent == INTERFACE_NONE || entry->parent < i);
+    }
+    for(uint32_t i = 0; i < header->exportCount && valid; ++i)
+        valid = module->exports[i] < header->entryCount;
+
+    if(!valid)
+        closeInterface(module);
+    return valid;
+}
+
+void closeInterface(Interface* module)
+{
+    closeInput(&module->input);
+    module->header = NULL;
+}
+
+void initializeInterfaceTable(InterfaceTable* table, const char* directory)
+{
+    table->directory  = directory;
+    table->interfaces = NULL;
+    table->count      = 0;
+    table->capacity   = 0;
+}
+
+void finalizeInterfaceTable(InterfaceTable* table)
+{
+    for(size_t i = 0; i < table->count; ++i)
+        closeInterface(&table->interfaces[i]);
+
+    free(table->interfaces);
+    table->interfaces = NULL;
+    table->count      = 0;
+    table->capacity   = 0;
+}
+
+const Interface* useInterface(InterfaceTable* table, const char* name, size_t length)
+{
+    for(size_t i = 0; i < table->count; ++i)
+    {
+        Interface* module = &table->interfaces[i];
+        if(compareNames(module->text + module->header->name, module->header->length, name, length) != 0)
+            continue;
+        if(module->checked || (interfaceCurrent(module, table->directory) && sourceCurrent(module)))
+        {
+            module->checked = true;
+            return module;
+        }
+
+        // Written again, removed or left behind by its source, the last one takes its place
+        closeInterface(module);
+        *module = table->interfaces[--table->count];
+        break;
+    }
+
+    if(table->count == table->capacity)
+    {
+        size_t     capacity   = table->capacity > 0 ? table->capacity * 2 : 8;
+        Interface* interfaces = realloc(table->interfaces, capacity * sizeof(Interface));
+        if(interfaces == NULL)
+            return NULL;
+
+        table->interfaces = interfaces;
+        table->capacity   = capacity;
+    }
+
+    Interface* module = &table->interfaces[table->count];
+    if(!openInterface(module, table->directory, name, length))
+        return NULL;
+    if(!sourceCurrent(module))
+    {
+        closeInterface(module);
+        return NULL;
+    }
+    module->checked = true;
+    return &table->interfaces[table->count++];
+}
+
+void recheckInterfaces(InterfaceTable* table)
+{
+    for(size_t i = 0; i < table->count; ++i)
+        table->interfaces[i].checked = false;
+}
+
+bool interfaceSource(const InterfaceTable* table, const char* name, size_t length, char* source, size_t size)
+{
+    Interface module;
+    if(!openInterface(&module, table->directory, name, length))
+        return false;
+
+    int written = snprintf(source, size, "%s", module.text + module.header->source);
+    closeInterface(&module);
+    return written > 0 && (size_t)written < size;
+}
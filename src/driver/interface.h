@@ -0,0 +1,98 @@
+#ifndef HEADER_INTERFACE
+#define HEADER_INTERFACE
+
+#include "../lexer/input.h"
+#include "../parser/ast.h"
+#include "../util/interner.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Module interfaces
+ */
+
+// A module 'name = mod ... end' is used through its interface file 'name.dudei',
+// so its source is never lexed again. Bump the version whenever the format changes.
+#define INTERFACE_VERSION 4
+
+#define INTERFACE_MAGIC 0x49445544  // "DUDI"
+
+#define INTERFACE_NONE UINT32_MAX
+
+// Exported names follow each other in source order, each one followed by its parts
+typedef struct InterfaceEntry
+{
+    uint8_t  kind;    // NDAssignment, NDDat, NDField, NDFun, NDParameter or NDMod
+    uint8_t  type;    // Declared type
+    uint16_t unused;
+    uint32_t parent;  // Entry this one is part of, INTERFACE_NONE at the top
+    uint32_t name;    // Offset of the zero terminated name in the text
+    uint32_t length;
+} InterfaceEntry;
+
+// Followed by the entries, the indices of the top entries sorted by name and the text
+typedef struct InterfaceHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;   // Cache key of the source it was built from
+    uint64_t hash;  // Of everything behind the header, sources using the module depend on it
+    uint64_t sourceSize;  // Stamp of the source when it was read
+    uint64_t sourceModified;
+    uint32_t entryCount;
+    uint32_t exportCount;
+    uint32_t textSize;
+    uint32_t name;  // Name of the module in the text
+    uint32_t length;
+    uint32_t source;  // Absolute path of the source defining the module in the text
+    uint32_t sourceLength;
+    uint32_t unused;
+} InterfaceHeader;
+
+// An interface file mapped read only
+typedef struct Interface
+{
+    Input                  input;
+    const InterfaceHeader* header;
+    const InterfaceEntry*  entries;
+    const uint32_t*        exports;
+    const char*            text;
+    bool                   checked;  // Known to match its file since the last recheck
+} Interface;
+
+// Writes the interface of the module assigned by node 'assignment' in the file 'source',
+// an absolute path opened with 'stamp', unless the interface already comes from that
+// file as it is. 'writer' names the temporary file.
+bool writeInterface(const char* directory, const Ast* ast, NodeIndex assignment, const Interner* interner, uint64_t key,
+                    const char* source, const InputStamp* stamp, unsigned writer);
+
+bool openInterface(Interface* module, const char* directory, const char* name, size_t length);
+
+void closeInterface(Interface* module);
+
+// Interfaces used by the sources of one worker, each is mapped on its first use
+typedef struct InterfaceTable
+{
+    const char* directory;
+    Interface*  interfaces;
+    size_t      count;
+    size_t      capacity;
+} InterfaceTable;
+
+void initializeInterfaceTable(InterfaceTable* table, const char* directory);
+
+void finalizeInterfaceTable(InterfaceTable* table);
+
+// Returns NULL if the module has no interface, or its source is gone or changed since.
+// The source is only compared by its stamp, it is never read.
+const Interface* useInterface(InterfaceTable* table, const char* name, size_t length);
+
+// Copies the source recorded by the interface of a module, false if it has none
+bool interfaceSource(const InterfaceTable* table, const char* name, size_t length, char* source, size_t size);
+
+// Before the next source, as interfaces may have been written again since. Each one
+// is compared by the header of its file on its next use and mapped again if it changed.
+void recheckInterfaces(InterfaceTable* table);
+
+#endif  // HEADER_INTERFACE
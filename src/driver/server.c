@@ -0,0 +1,236 @@
+#include "server.h"
+#include "driver.h"
+#include "../util/socket.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#define chdir _chdir
+#else
+#include <unistd.h>
+#endif
+
+#define SERVER_PATH_SIZE 4096
+
+/*
+ * Private helpers
+ */
+
+// Paths are resolved once, the server enters the directory of each client
+bool absolutePath(char* buffer, const char* directory, const char* path)
+{
+    bool absolute = path[0] == '/' || path[0] == '\\' || (path[0] != '\0' && path[1] == ':');
+    int  length   = absolute ? snprintf(buffer, SERVER_PATH_SIZE, "%s", path)
+                             : snprintf(buffer, SERVER_PATH_SIZE, "%s/%s", directory, path);
+    return length > 0 && length < SERVER_PATH_SIZE;
+}
+
+bool sendReply(Socket* client, size_t failed, const TextBuffer* output)
+{
+    ServerReply reply = {.magic = SERVER_MAGIC, .failed = (uint32_t)failed, .size = output->size};
+    return sendSocket(client, &reply, sizeof(reply)) && sendSocket(client, output->text, output->size);
+}
+
+// Compiles the files of one request, false once a client stops the server
+bool serveRequest(Driver* driver, Socket* client)
+{
+    ServerRequest request;
+    if(!receiveSocket(client, &request, sizeof(request)) || request.magic != SERVER_MAGIC ||
+       request.version != SERVER_VERSION || request.size == 0 || request.size > SERVER_REQUEST_LIMIT ||
+       request.count > request.size)
+        return true;
+
+    // Read in full before the reply, closing on unread bytes may drop the reply
+    char*        body      = malloc(request.size + 1);
+    const char** filenames = malloc((request.count + 1) * sizeof(const char*));
+    if(body == NULL || filenames == NULL || !receiveSocket(client, body, request.size))
+    {
+        free(body);
+        free(filenames);
+        return true;
+    }
+
+    TextBuffer output;
+    initializeTextBuffer(&output);
+    if(request.command == SCStop)
+    {
+        sendReply(client, 0, &output);
+        free(filenames);
+        free(body);
+        return false;
+    }
+
+    // The names follow the directory, a missing terminator ends the last one
+    size_t position = 0;
+    body[request.size] = '\0';
+    for(size_t i = 0; i <= request.count; ++i)
+    {
+        filenames[i] = position < request.size ? body + position : NULL;
+        position += filenames[i] != NULL ? strlen(filenames[i]) + 1 : 0;
+    }
+
+    size_t failed = request.count;
+    if(filenames[request.count] == NULL)
+        appendText(&output, "Malformed request\n");
+    else if(chdir(body) != 0)
+        appendText(&output, "Could not enter '%s'\n", body);
+    else
+        failed = runDriver(driver, filenames + 1, request.count, &output);
+
+    sendReply(client, failed, &output);
+    finalizeTextBuffer(&output);
+    free(filenames);
+    free(body);
+    return true;
+}
+
+// Sends one request and prints the diagnostics of the reply
+bool sendRequest(const char* path, ServerCommand command, const char* body, size_t size, size_t count, size_t* failed)
+{
+    Socket connection;
+    if(!connectSocket(&connection, path))
+    {
+        printf("No server listens on '%s'\n", path);
+        return false;
+    }
+
+    ServerRequest request = {
+        .magic   = SERVER_MAGIC,
+        .version = SERVER_VERSION,
+        .command = command,
+        .count   = (uint32_t)count,
+        .size    = (uint32_t)size,
+    };
+    ServerReply reply;
+    bool        answered = sendSocket(&connection, &request, sizeof(request)) && sendSocket(&connection, body, size) &&
+                    receiveSocket(&connection, &reply, sizeof(reply)) && reply.magic == SERVER_MAGIC;
+
+    // Diagnostics are passed on as they arrive
+    char     buffer[4096];
+    uint64_t left = answered ? reply.size : 0;
+    while(left > 0 && answered)
+    {
+        size_t chunk = left < sizeof(buffer) ? (size_t)left : sizeof(buffer);
+        answered     = receiveSocket(&connection, buffer, chunk);
+        fwrite(buffer, 1, answered ? chunk : 0, stdout);
+        left -= chunk;
+    }
+
+    closeSocket(&connection);
+    if(!answered)
+    {
+        printf("The server on '%s' did not answer\n", path);
+        return false;
+    }
+
+    *failed = reply.failed;
+    return true;
+}
+
+/*
+ * Compile server
+ */
+
+bool serveCompiles(const char* path, unsigned threads, const char* cache, const char* modules)
+{
+    char directory[SERVER_PATH_SIZE];
+    char socketPath[SERVER_PATH_SIZE];
+    char cacheDirectory[SERVER_PATH_SIZE];
+    char modulesDirectory[SERVER_PATH_SIZE];
+    if(getcwd(directory, sizeof(directory)) == NULL || !absolutePath(socketPath, directory, path) ||
+       (cache != NULL && !absolutePath(cacheDirectory, directory, cache)) ||
+       (modules != NULL && !absolutePath(modulesDirectory, directory, modules)))
+    {
+        printf("Could not resolve the paths\n");
+        return false;
+    }
+
+    Driver driver;
+    if(!initializeDriver(&driver, threads, cache != NULL ? cacheDirectory : NULL, modules != NULL ? modulesDirectory : NULL))
+    {
+        printf("Out of memory\n");
+        return false;
+    }
+
+    Socket server;
+    if(!listenSocket(&server, socketPath))
+    {
+        printf("Could not listen on '%s'\n", path);
+        finalizeDriver(&driver);
+        return false;
+    }
+
+    // One client at a time, the workers are busy with its files anyway. A client
+    // that stalls is dropped, so it can not keep the others waiting.
+    Socket client;
+    bool   serving = true;
+    while(serving && acceptSocket(&server, &client))
+    {
+        if(limitSocket(&client, SERVER_TIMEOUT))
+            serving = serveRequest(&driver, &client);
+        closeSocket(&client);
+    }
+
+    closeSocket(&server);
+    removeSocket(socketPath);
+    finalizeDriver(&driver);
+    return true;
+}
+
+bool requestCompile(const char* path, const char* const* filenames, size_t count, size_t* failed)
+{
+    // Names are sent as given, the server opens them from the same directory
+    char   directory[SERVER_PATH_SIZE];
+    size_t size = 0;
+    if(getcwd(directory, sizeof(directory)) == NULL)
+    {
+        printf("Could not resolve the directory\n");
+        return false;
+    }
+
+    size += strlen(directory) + 1;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(strcmp(filenames[i], "-") == 0)
+        {
+            printf("Standard input can not be sent to a server\n");
+            return false;
+        }
+        size += strlen(filenames[i]) + 1;
+    }
+
+    if(size > SERVER_REQUEST_LIMIT)
+    {
+        printf("Too many files for one request\n");
+        return false;
+    }
+
+    char* body = malloc(size);
+    if(body == NULL)
+    {
+        printf("Out of memory\n");
+        return false;
+    }
+
+    size_t position = 0;
+    for(size_t i = 0; i <= count; ++i)
+    {
+        const char* name   = i == 0 ? directory : filenames[i - 1];
+        size_t      length = strlen(name) + 1;
+        memcpy(body + position, name, length);
+        position += length;
+    }
+
+    bool sent = sendRequest(path, SCCompile, body, size, count, failed);
+    free(body);
+    return sent;
+}
+
+bool requestStop(const char* path)
+{
+    size_t failed;
+    return sendRequest(path, SCStop, "", 1, 0, &failed);
+}
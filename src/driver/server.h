@@ -0,0 +1,60 @@
+#ifndef HEADER_SERVER
+#define HEADER_SERVER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compile server
+ */
+
+// A server keeps its driver between requests, so the tables of its workers, the interfaces
+// they mapped and their cache entries are ready for the next files. Clients only send the
+// names of the files and print the diagnostics they get back.
+#define SERVER_VERSION 1
+
+#define SERVER_MAGIC 0x52445544  // "DUDR"
+
+// Clients that keep the server waiting longer are dropped
+#define SERVER_TIMEOUT 5000  // Milliseconds
+
+// Larger requests are refused unread
+#define SERVER_REQUEST_LIMIT (1 << 24)
+
+typedef enum ServerCommand
+{
+    SCCompile,
+    SCStop,
+} ServerCommand;
+
+// Followed by the working directory of the client and the names of the files, each zero terminated
+typedef struct ServerRequest
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t command;
+    uint32_t count;
+    uint32_t size;  // Bytes behind the header
+    uint32_t unused;
+} ServerRequest;
+
+// Followed by the diagnostics
+typedef struct ServerReply
+{
+    uint32_t magic;
+    uint32_t failed;  // Files that failed
+    uint64_t size;
+} ServerReply;
+
+// Answers the requests on 'path' one after another until one stops the server.
+// Returns false if it could not start.
+bool serveCompiles(const char* path, unsigned threads, const char* cache, const char* modules);
+
+// Has the server on 'path' compile the files and prints its diagnostics.
+// Returns false if there is no server to ask.
+bool requestCompile(const char* path, const char* const* filenames, size_t count, size_t* failed);
+
+bool requestStop(const char* path);
+
+#endif  // HEADER_SERVER
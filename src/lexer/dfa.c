@@ -0,0 +1,142 @@
+#include "dfa.h"
+#include "symbols.h"
+
+/*
+ * Character classes
+ */
+
+const unsigned char charClasses[256] = {
+    [SYMSpace]          = CCSpace,
+    [SYMCarriageReturn] = CCSpace,
+    [SYMNewline]        = CCNewline,
+    [SYMNumberSign]     = CCNumberSign,
+
+    [SYMSmallA... SYMSmallZ] = CCAlpha,
+    [SYMBigA... SYMBigZ]     = CCAlpha,
+    [SYMZero... SYMNine]     = CCDigit,
+
+    [SYMAtSign]     = CCControl,
+    [SYMDollarSign] = CCControl,
+    [SYMPeriod]     = CCControl,
+
+    [SYMEqualSign]       = CCEqualSign,
+    [SYMAsterisk]        = CCAsterisk,
+    [SYMSlash]           = CCSlash,
+    [SYMPlusSign]        = CCPlusSign,
+    [SYMMinusSign]       = CCMinusSign,
+    [SYMPercentSign]     = CCPercentSign,
+    [SYMAmpersand]       = CCAmpersand,
+    [SYMVerticalBar]     = CCVerticalBar,
+    [SYMCircumflex]      = CCCircumflex,
+    [SYMTilde]           = CCTilde,
+    [SYMGreaterThanSign] = CCGreaterThanSign,
+    [SYMLessThanSign]    = CCLessThanSign,
+
+    [SYMDoubleQuote]      = CCDoubleQuote,
+    [SYMSingleQuote]      = CCSingleQuote,
+    [SYMCurlyBracesOpen]  = CCCurlyBracesOpen,
+    [SYMCurlyBracesClose] = CCCurlyBracesClose,
+    [SYMParenthesisOpen]  = CCParenthesisOpen,
+    [SYMParenthesisClose] = CCParenthesisClose,
+    [SYMBracketOpen]      = CCBracketOpen,
+    [SYMBracketClose]     = CCBracketClose,
+    [SYMComma]            = CCComma,
+    [SYMColon]            = CCColon,
+};
+
+/*
+ * Transitions
+ */
+
+const unsigned char dfaTransitions[DFACount][CCCount] = {
+    [DFAStart] =
+        {
+            [CCAlpha]            = DFAIdentifier,
+            [CCDigit]            = DFANumber,
+            [CCControl]          = DFAControl,
+            [CCEqualSign]        = DFAAssignment,
+            [CCAsterisk]         = DFAAsterisk,
+            [CCSlash]            = DFASlash,
+            [CCPlusSign]         = DFAPlusSign,
+            [CCMinusSign]        = DFAMinusSign,
+            [CCPercentSign]      = DFAPercentSign,
+            [CCAmpersand]        = DFAAmpersand,
+            [CCVerticalBar]      = DFAVerticalBar,
+            [CCCircumflex]       = DFACircumflex,
+            [CCTilde]            = DFATilde,
+            [CCGreaterThanSign]  = DFAGreaterThanSign,
+            [CCLessThanSign]     = DFALessThanSign,
+            [CCDoubleQuote]      = DFAString,
+            [CCSingleQuote]      = DFACharacter,
+            [CCCurlyBracesOpen]  = DFACurlyBracesOpen,
+            [CCCurlyBracesClose] = DFACurlyBracesClose,
+            [CCParenthesisOpen]  = DFAParenthesisOpen,
+            [CCParenthesisClose] = DFAParenthesisClose,
+            [CCBracketOpen]      = DFABracketOpen,
+            [CCBracketClose]     = DFABracketClose,
+            [CCComma]            = DFAComma,
+            [CCColon]            = DFAColon,
+        },
+
+    // Multi character operators
+    [DFAAssignment]      = {[CCEqualSign] = DFAEqual},
+    [DFAAsterisk]        = {[CCAsterisk] = DFAPower, [CCEqualSign] = DFAAssignmentMultiplication},
+    [DFASlash]           = {[CCSlash] = DFAFloorDivision, [CCEqualSign] = DFAAssignmentDivision},
+    [DFAPlusSign]        = {[CCEqualSign] = DFAAssignmentAddition},
+    [DFAMinusSign]       = {[CCEqualSign] = DFAAssignmentSubtraction},
+    [DFAPercentSign]     = {[CCEqualSign] = DFAAssignmentModulo},
+    [DFAAmpersand]       = {[CCEqualSign] = DFAAssignmentAND},
+    [DFAVerticalBar]     = {[CCEqualSign] = DFAAssignmentOR},
+    [DFACircumflex]      = {[CCEqualSign] = DFAAssignmentXOR},
+    [DFAGreaterThanSign] = {[CCEqualSign] = DFAGreaterEqual},
+    [DFALessThanSign]    = {[CCEqualSign] = DFALessEqual},
+};
+
+/*
+ * Accepting states
+ */
+
+const unsigned char dfaAccepts[DFACount] = {
+    [DFAStop]       = TKInvalid,
+    [DFAStart]      = TKInvalid,
+    [DFAIdentifier] = TKIdentifier,
+    [DFANumber]     = TKNumericConstant,
+    [DFAString]     = TKStringConstant,
+    [DFACharacter]  = TKCharacterConstant,
+    [DFAControl]    = TKUndefined,
+
+    [DFAAssignment]               = TKAssignment,
+    [DFAEqual]                    = TKOperatorEqual,
+    [DFAAsterisk]                 = TKOperatorMultiplication,
+    [DFAPower]                    = TKOperatorPower,
+    [DFAAssignmentMultiplication] = TKAssignmentMultiplication,
+    [DFASlash]                    = TKOperatorDivision,
+    [DFAFloorDivision]            = TKOperatorFloorDivision,
+    [DFAAssignmentDivision]       = TKAssignmentDivision,
+    [DFAPlusSign]                 = TKOperatorAddition,
+    [DFAAssignmentAddition]       = TKAssignmentAddition,
+    [DFAMinusSign]                = TKOperatorSubtraction,
+    [DFAAssignmentSubtraction]    = TKAssignmentSubtraction,
+    [DFAPercentSign]              = TKOperatorModulo,
+    [DFAAssignmentModulo]         = TKAssignmentModulo,
+    [DFAAmpersand]                = TKOperatorAND,
+    [DFAAssignmentAND]            = TKAssignmentAND,
+    [DFAVerticalBar]              = TKOperatorOR,
+    [DFAAssignmentOR]             = TKAssignmentOR,
+    [DFACircumflex]               = TKOperatorXOR,
+    [DFAAssignmentXOR]            = TKAssignmentXOR,
+    [DFATilde]                    = TKOperatorCOMP,
+    [DFAGreaterThanSign]          = TKOperatorGreaterThan,
+    [DFAGreaterEqual]             = TKOperatorGreaterEqual,
+    [DFALessThanSign]             = TKOperatorLessThan,
+    [DFALessEqual]                = TKOperatorLessEqual,
+
+    [DFACurlyBracesOpen]  = TKBlockBegin,
+    [DFACurlyBracesClose] = TKBlockEnd,
+    [DFAParenthesisOpen]  = TKExpressionBegin,
+    [DFAParenthesisClose] = TKExpressionEnd,
+    [DFABracketOpen]      = TKSliceBegin,
+    [DFABracketClose]     = TKSliceEnd,
+    [DFAComma]            = TKCommaSeparator,
+    [DFAColon]            = TKColonSeparator,
+};
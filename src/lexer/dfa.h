@@ -0,0 +1,102 @@
+#ifndef HEADER_DFA
+#define HEADER_DFA
+
+#include "tokens.h"
+
+/*
+ * Character classes
+ */
+
+typedef enum CharClass
+{
+    CCInvalid,
+    CCEnd,
+    CCSpace,
+    CCNewline,
+    CCNumberSign,
+    CCAlpha,
+    CCDigit,
+    CCControl,
+    CCEqualSign,
+    CCAsterisk,
+    CCSlash,
+    CCPlusSign,
+    CCMinusSign,
+    CCPercentSign,
+    CCAmpersand,
+    CCVerticalBar,
+    CCCircumflex,
+    CCTilde,
+    CCGreaterThanSign,
+    CCLessThanSign,
+    CCDoubleQuote,
+    CCSingleQuote,
+    CCCurlyBracesOpen,
+    CCCurlyBracesClose,
+    CCParenthesisOpen,
+    CCParenthesisClose,
+    CCBracketOpen,
+    CCBracketClose,
+    CCComma,
+    CCColon,
+    CCCount
+} CharClass;
+
+extern const unsigned char charClasses[256];
+
+/*
+ * Scanner states
+ */
+
+typedef enum DFAState
+{
+    DFAStop,
+    DFAStart,
+    DFAIdentifier,
+    DFANumber,
+    DFAString,
+    DFACharacter,
+    DFAControl,
+    DFAAssignment,
+    DFAEqual,
+    DFAAsterisk,
+    DFAPower,
+    DFAAssignmentMultiplication,
+    DFASlash,
+    DFAFloorDivision,
+    DFAAssignmentDivision,
+    DFAPlusSign,
+    DFAAssignmentAddition,
+    DFAMinusSign,
+    DFAAssignmentSubtraction,
+    DFAPercentSign,
+    DFAAssignmentModulo,
+    DFAAmpersand,
+    DFAAssignmentAND,
+    DFAVerticalBar,
+    DFAAssignmentOR,
+    DFACircumflex,
+    DFAAssignmentXOR,
+    DFATilde,
+    DFAGreaterThanSign,
+    DFAGreaterEqual,
+    DFALessThanSign,
+    DFALessEqual,
+    DFACurlyBracesOpen,
+    DFACurlyBracesClose,
+    DFAParenthesisOpen,
+    DFAParenthesisClose,
+    DFABracketOpen,
+    DFABracketClose,
+    DFAComma,
+    DFAColon,
+    DFACount
+} DFAState;
+
+// Next state for the current state and character class, DFAStop ends the token
+extern const unsigned char dfaTransitions[DFACount][CCCount];
+
+// Token produced when the scanner stops in a state
+extern const unsigned char dfaAccepts[DFACount];
+
+#endif  // HEADER_DFA
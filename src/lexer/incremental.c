@@ -0,0 +1,271 @@
+#include "incremental.h"
+
+/*
+ * Private helpers
+ */
+
+size_t tokensBehind(const Document* document)
+{
+    return document->tokens.capacity - document->after;
+}
+
+// Tokens behind the gap store their distance to the end of the text
+size_t tokenStart(const Document* document, size_t index)
+{
+    const TokenStream* tokens = &document->tokens;
+    if(index < document->gap)
+        return tokens->offsets[index];
+    return document->size - tokens->offsets[index - document->gap + document->after];
+}
+
+void copyToken(TokenStream* tokens, size_t to, size_t from)
+{
+    tokens->kinds[to]   = tokens->kinds[from];
+    tokens->flags[to]   = tokens->flags[from];
+    tokens->values[to]  = tokens->values[from];
+    tokens->offsets[to] = tokens->offsets[from];
+    tokens->lengths[to] = tokens->lengths[from];
+}
+
+// Puts the gap in front of token 'index', only the tokens in between move
+void moveGap(Document* document, size_t index)
+{
+    TokenStream* tokens = &document->tokens;
+    while(document->gap > index)
+    {
+        document->gap--;
+        document->after--;
+        copyToken(tokens, document->after, document->gap);
+        tokens->offsets[document->after] = (uint32_t)(document->size - tokens->offsets[document->after]);
+    }
+    while(document->gap < index)
+    {
+        copyToken(tokens, document->gap, document->after);
+        tokens->offsets[document->gap] = (uint32_t)(document->size - tokens->offsets[document->gap]);
+        document->gap++;
+        document->after++;
+    }
+}
+
+bool growGap(Document* document)
+{
+    TokenStream* tokens   = &document->tokens;
+    size_t       capacity = tokens->capacity;
+    size_t       behind   = tokensBehind(document);
+    if(!reserveTokens(tokens, capacity * 2))
+        return false;
+
+    // The tokens behind the gap move to the end of the larger arrays
+    size_t after = tokens->capacity - behind;
+    memmove(tokens->kinds + after, tokens->kinds + document->after, behind * sizeof(uint8_t));
+    memmove(tokens->flags + after, tokens->flags + document->after, behind * sizeof(uint8_t));
+    memmove(tokens->values + after, tokens->values + document->after, behind * sizeof(uint64_t));
+    memmove(tokens->offsets + after, tokens->offsets + document->after, behind * sizeof(uint32_t));
+    memmove(tokens->lengths + after, tokens->lengths + document->after, behind * sizeof(uint32_t));
+    document->after = after;
+    return true;
+}
+
+bool insertToken(Document* document, const Lexeme* lexeme)
+{
+    if(document->gap == document->after && !growGap(document))
+        return false;
+
+    TokenStream* tokens             = &document->tokens;
+    tokens->kinds[document->gap]   = (uint8_t)lexeme->tok;
+    tokens->flags[document->gap]   = (uint8_t)lexeme->flags;
+    tokens->values[document->gap]  = lexeme->value;
+    tokens->offsets[document->gap] = (uint32_t)lexeme->offset;
+    tokens->lengths[document->gap] = lexeme->length;
+    document->gap++;
+    return true;
+}
+
+// Lexes from 'restart' into the gap, old tokens starting in front of 'limit' are dropped
+bool relex(Document* document, size_t restart, size_t limit)
+{
+    TokenStream* tokens     = &document->tokens;
+    Diagnostic   diagnostic = {.set = false};
+    bool         inserted   = true;
+
+    Lexer lexer;
+    initializeLexerMemory(&lexer, document->text + restart, document->size - restart, restart, document->interner);
+    lexer.deferred = &diagnostic;
+    lexer.strings  = document->strings;
+
+    size_t behind     = tokensBehind(document);
+    document->changed = document->gap;
+    document->relexed = 0;
+    for(;;)
+    {
+        Token  tok    = tokenize(&lexer);
+        Lexeme lexeme = currentLexeme(&lexer);
+
+        // Old tokens in the edit or passed over by the new ones are gone
+        while(tokensBehind(document) > 0 && (tokenStart(document, document->gap) < limit ||
+                                             tokenStart(document, document->gap) < lexeme.offset))
+            document->after++;
+
+        // The same token at the same place behind the edit, from here on nothing changed
+        if(tokensBehind(document) > 0 && tokenStart(document, document->gap) == lexeme.offset &&
+           tokens->kinds[document->after] == tok && tokens->lengths[document->after] == lexeme.length)
+        {
+            tokens->flags[document->after] = (uint8_t)lexeme.flags;
+            break;
+        }
+
+        inserted = insertToken(document, &lexeme);
+        document->relexed++;
+        if(!inserted || tok == TKEnd || tok == TKInvalid)
+        {
+            document->after = tokens->capacity;
+            break;
+        }
+    }
+
+    document->dropped = behind - tokensBehind(document);
+
+    // The error of the last token is the new one or the old one behind the edit
+    if(diagnostic.set)
+        document->error = diagnostic;
+    if(documentTokenCount(document) == 0 ||
+       tokens->kinds[tokensBehind(document) > 0 ? tokens->capacity - 1 : document->gap - 1] != TKInvalid)
+        document->error.set = false;
+
+    document->strings = lexer.strings;
+    initializeArena(&lexer.strings, 0);
+    finalizeLexer(&lexer);
+    return inserted;
+}
+
+/*
+ * Incremental lexing
+ */
+
+bool openDocument(Document* document, const char* text, size_t size, Interner* interner)
+{
+    document->text      = text;
+    document->size      = size;
+    document->gap       = 0;
+    document->interner  = interner;
+    document->error.set = false;
+    document->changed   = 0;
+    document->relexed   = 0;
+    document->dropped   = 0;
+    initializeTokenStream(&document->tokens, text, size / 4);
+    initializeArena(&document->strings, 0);
+    initializeLineIndex(&document->lines);
+    document->after = document->tokens.capacity;
+
+    if(size > UINT32_MAX || document->tokens.capacity == 0)
+        return false;
+    return relex(document, 0, size);
+}
+
+void closeDocument(Document* document)
+{
+    finalizeTokenStream(&document->tokens);
+    finalizeArena(&document->strings);
+    finalizeLineIndex(&document->lines);
+    document->gap   = 0;
+    document->after = 0;
+}
+
+bool editDocument(Document* document, const char* text, size_t size, size_t offset, size_t removed, size_t inserted)
+{
+    if(size > UINT32_MAX)
+        return false;
+
+    // Tokens up to the last one ending in front of the edit stay, the character
+    // ending a token decides where it ends, so it must not be edited either
+    size_t count = documentTokenCount(document);
+    size_t low   = 0;
+    size_t high  = count;
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        size_t length = middle < document->gap ? document->tokens.lengths[middle]
+                                               : document->tokens.lengths[middle - document->gap + document->after];
+        if(tokenStart(document, middle) + length < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    moveGap(document, low);
+
+    // Behind the gap the offsets are kept from the end, so they fit the new text as they are
+    document->text          = text;
+    document->size          = size;
+    document->tokens.source = text;
+    truncateLineIndex(&document->lines, offset);
+    if(document->error.set && document->error.offset >= offset + removed)
+        document->error.offset = document->error.offset - removed + inserted;
+
+    // Nothing is lexed behind an error
+    if(low > 0 && document->tokens.kinds[low - 1] == TKInvalid)
+    {
+        document->changed = low;
+        document->relexed = 0;
+        document->dropped = 0;
+        return true;
+    }
+
+    size_t restart = low > 0 ? document->tokens.offsets[low - 1] + document->tokens.lengths[low - 1] : 0;
+    return relex(document, restart, offset + inserted);
+}
+
+size_t documentTokenCount(const Document* document)
+{
+    return document->gap + tokensBehind(document);
+}
+
+Lexeme documentToken(const Document* document, size_t index)
+{
+    const TokenStream* tokens = &document->tokens;
+    size_t             at     = index < document->gap ? index : index - document->gap + document->after;
+
+    Lexeme lexeme;
+    lexeme.tok    = (Token)tokens->kinds[at];
+    lexeme.flags  = tokens->flags[at];
+    lexeme.value  = tokens->values[at];
+    lexeme.offset = tokenStart(document, index);
+    lexeme.length = tokens->lengths[at];
+    lexeme.text   = document->text + lexeme.offset;
+    return lexeme;
+}
+
+Location documentLocation(Document* document, size_t offset)
+{
+    size_t line      = findLine(&document->lines, document->text, document->size, offset);
+    size_t lineStart = document->lines.count > 0 ? document->lines.starts[line] : 0;
+
+    const char* text  = document->text + lineStart;
+    const char* end   = document->text + document->size;
+    const char* found = memchr(text, SYMNewline, end - text);
+    const char* stop  = found != NULL ? found : end;
+    if(stop > text && stop[-1] == '\r')
+        stop--;
+
+    Location location;
+    location.line   = (unsigned)line + 1;
+    location.col    = (unsigned)(offset - lineStart) + 1;
+    location.text   = text;
+    location.length = (unsigned)(stop - text);
+    return location;
+}
+
+void documentSource(void* context, Lexeme* lexeme)
+{
+    DocumentReader* reader = context;
+    size_t          count  = documentTokenCount(reader->document);
+    if(count == 0)
+    {
+        *lexeme = (Lexeme){.tok = TKEnd, .text = reader->document->text};
+        return;
+    }
+
+    *lexeme = documentToken(reader->document, reader->index);
+    if(reader->index + 1 < count)
+        reader->index++;
+}
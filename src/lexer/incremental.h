@@ -0,0 +1,58 @@
+#ifndef HEADER_INCREMENTAL
+#define HEADER_INCREMENTAL
+
+#include "lexer.h"
+#include "tokenring.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Incremental lexing
+ */
+
+// Tokens of a source edited in place, as for editors. The caller owns the text.
+// The token arrays have a gap at the last edit, tokens behind it keep their
+// distance to the end of the text, so an edit only touches the tokens it changes
+// and those between it and the last edit.
+typedef struct Document
+{
+    const char* text;
+    size_t      size;
+    TokenStream tokens;   // Arrays with the gap, 'count' is unused
+    size_t      gap;      // Tokens in front of the gap
+    size_t      after;    // Index of the first token behind the gap
+    Arena       strings;  // Decoded string constants, kept across edits
+    Interner*   interner;
+    LineIndex   lines;
+    Diagnostic  error;    // Set while the last token is TKInvalid
+    size_t      changed;  // Index of the first token lexed by the last edit
+    size_t      relexed;  // Tokens lexed by the last edit
+    size_t      dropped;  // Old tokens they replaced
+} Document;
+
+bool openDocument(Document* document, const char* text, size_t size, Interner* interner);
+
+void closeDocument(Document* document);
+
+// 'text' is the source after replacing 'removed' bytes at 'offset' with 'inserted' bytes.
+// Lexing starts at the last token ending in front of the edit and stops as soon
+// as a token lines up with the old one at the same place behind the edit.
+bool editDocument(Document* document, const char* text, size_t size, size_t offset, size_t removed, size_t inserted);
+
+size_t documentTokenCount(const Document* document);
+
+Lexeme documentToken(const Document* document, size_t index);
+
+Location documentLocation(Document* document, size_t offset);
+
+// Tokens of a document in order
+typedef struct DocumentReader
+{
+    const Document* document;
+    size_t          index;
+} DocumentReader;
+
+// 'context' is a DocumentReader
+void documentSource(void* context, Lexeme* lexeme);
+
+#endif  // HEADER_INCREMENTAL
@@ -0,0 +1,279 @@
+#include "input.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Data of unmapped inputs
+static const char empty[1] = "";
+
+/*
+ * Platform mapping
+ */
+
+#ifdef _WIN32
+
+bool mapInput(Input* input, const char* filename)
+{
+    HANDLE file = CreateFileA(
+        filename,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // Pipes and devices are streamed instead
+    LARGE_INTEGER size;
+    FILETIME      modified;
+    if(GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || !GetFileTime(file, NULL, NULL, &modified))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    input->file           = file;
+    input->size           = (size_t)size.QuadPart;
+    input->stamp.size     = (uint64_t)size.QuadPart;
+    input->stamp.modified = (uint64_t)modified.dwHighDateTime << 32 | modified.dwLowDateTime;
+
+    // Empty files can not be mapped
+    if(input->size == 0)
+        return true;
+
+    input->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(input->mapping == NULL)
+        return false;
+
+    const char* data = MapViewOfFile(input->mapping, FILE_MAP_READ, 0, 0, 0);
+    if(data == NULL)
+        return false;
+
+    input->data = data;
+    return true;
+}
+
+void unmapInput(Input* input)
+{
+    if(input->mapping != NULL)
+    {
+        if(input->data != empty)
+            UnmapViewOfFile(input->data);
+        CloseHandle(input->mapping);
+    }
+    if(input->file != NULL)
+        CloseHandle(input->file);
+}
+
+#else
+
+bool mapInput(Input* input, const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    // Pipes and devices are streamed instead
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    input->size           = (size_t)info.st_size;
+    input->stamp.size     = (uint64_t)info.st_size;
+    input->stamp.modified = (uint64_t)info.st_mtim.tv_sec * 1000000000 + (uint64_t)info.st_mtim.tv_nsec;
+
+    // Empty files can not be mapped
+    if(input->size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, input->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED)
+        return false;
+
+    madvise(data, input->size, MADV_SEQUENTIAL);
+
+    input->mapping = data;
+    input->data    = data;
+    return true;
+}
+
+void unmapInput(Input* input)
+{
+    if(input->mapping != NULL)
+        munmap(input->mapping, input->size);
+}
+
+#endif
+
+/*
+ * Streaming
+ */
+
+bool streamInput(Input* input, FILE* stream)
+{
+    if(stream == NULL)
+        return false;
+
+    input->mode   = InputStreamed;
+    input->stream = stream;
+    input->buffer = malloc(2 * INPUT_BLOCK_SIZE);
+    input->data   = input->buffer;
+    return input->buffer != NULL;
+}
+
+size_t refillInput(Input* input, size_t keep)
+{
+    if(input->mode != InputStreamed || feof(input->stream) || ferror(input->stream))
+        return 0;
+
+    if(keep > input->size)
+        keep = input->size;
+    if(keep > INPUT_BLOCK_SIZE)
+        keep = INPUT_BLOCK_SIZE;
+
+    // Count the lines of the dropped bytes, later locations only need the window
+    size_t      drop  = input->size - keep;
+    const char* found = input->data;
+    while((found = memchr(found, '\n', input->data + drop - found)) != NULL)
+    {
+        found++;
+        input->lines++;
+        input->lineStart = input->base + (size_t)(found - input->data);
+    }
+
+    memmove(input->buffer, input->data + drop, keep);
+    input->base += drop;
+
+    size_t read = fread(input->buffer + keep, 1, INPUT_BLOCK_SIZE, input->stream);
+
+    input->data = input->buffer;
+    input->size = keep + read;
+    return read;
+}
+
+/*
+ * Input
+ */
+
+void resetInput(Input* input)
+{
+    input->mode      = InputMapped;
+    input->data      = empty;
+    input->size      = 0;
+    input->base      = 0;
+    input->lines     = 0;
+    input->lineStart = 0;
+    input->file      = NULL;
+    input->mapping   = NULL;
+    input->stream    = NULL;
+    input->buffer    = NULL;
+    input->stamp     = (InputStamp){0, 0};
+}
+
+bool openInput(Input* input, const char* filename)
+{
+    resetInput(input);
+
+    if(filename == NULL || strcmp(filename, "-") == 0)
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        return streamInput(input, stdin);
+    }
+
+    if(mapInput(input, filename))
+        return true;
+
+    closeInput(input);
+
+    if(streamInput(input, fopen(filename, "rb")))
+        return true;
+
+    closeInput(input);
+    return false;
+}
+
+void borrowInput(Input* input, const char* data, size_t size, size_t base)
+{
+    // Nothing is mapped, so closing releases nothing
+    resetInput(input);
+    input->data = data;
+    input->size = size;
+    input->base = base;
+}
+
+#ifdef _WIN32
+
+bool stampInput(const char* filename, InputStamp* stamp)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if(!GetFileAttributesExA(filename, GetFileExInfoStandard, &info))
+        return false;
+
+    stamp->size     = (uint64_t)info.nFileSizeHigh << 32 | info.nFileSizeLow;
+    stamp->modified = (uint64_t)info.ftLastWriteTime.dwHighDateTime << 32 | info.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+bool absoluteInputPath(const char* filename, char* path)
+{
+    return _fullpath(path, filename, INPUT_PATH_SIZE) != NULL && GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+#else
+
+bool stampInput(const char* filename, InputStamp* stamp)
+{
+    struct stat info;
+    if(stat(filename, &info) != 0)
+        return false;
+
+    stamp->size     = (uint64_t)info.st_size;
+    stamp->modified = (uint64_t)info.st_mtim.tv_sec * 1000000000 + (uint64_t)info.st_mtim.tv_nsec;
+    return true;
+}
+
+bool absoluteInputPath(const char* filename, char* path)
+{
+    char* resolved = realpath(filename, NULL);
+    bool  fits     = resolved != NULL && strlen(resolved) < INPUT_PATH_SIZE;
+    if(fits)
+        strcpy(path, resolved);
+    free(resolved);
+    return fits;
+}
+
+#endif
+
+bool closeInput(Input* input)
+{
+    if(input->mode == InputMapped)
+        unmapInput(input);
+    else if(input->stream != NULL && input->stream != stdin)
+        fclose(input->stream);
+
+    free(input->buffer);
+    resetInput(input);
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef HEADER_INPUT
+#define HEADER_INPUT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Source input
+ */
+
+typedef enum InputMode
+{
+    InputMapped,    // Whole file mapped read-only into memory
+    InputStreamed,  // Pipes and stdin read block by block
+} InputMode;
+
+#define INPUT_BLOCK_SIZE 65536
+
+// Size and modification time of a file, tell whether it changed without reading it
+typedef struct InputStamp
+{
+    uint64_t size;
+    uint64_t modified;  // Ticks of the platform
+} InputStamp;
+
+typedef struct Input
+{
+    InputMode   mode;
+    const char* data;
+    size_t      size;
+    size_t      base;       // Offset of data[0] in the whole input
+    size_t      lines;      // Line breaks in front of data[0]
+    size_t      lineStart;  // Offset of the line containing data[0]
+    void*       file;
+    void*       mapping;
+    FILE*       stream;
+    char*       buffer;     // Two blocks: the previous one and the current one
+    InputStamp  stamp;      // Of mapped files as they were opened
+} Input;
+
+// Maps regular files and streams everything else, NULL or "-" reads stdin
+bool openInput(Input* input, const char* filename);
+
+// Reads 'size' bytes of memory owned by the caller, 'base' is the offset of data[0] in the whole input
+void borrowInput(Input* input, const char* data, size_t size, size_t base);
+
+bool closeInput(Input* input);
+
+#define INPUT_PATH_SIZE 4096
+
+// Returns false if there is no such file
+bool stampInput(const char* filename, InputStamp* stamp);
+
+// Absolute path of an existing file, false if there is none or it does not fit INPUT_PATH_SIZE
+bool absoluteInputPath(const char* filename, char* path);
+
+// Keeps the last 'keep' bytes (at most one block) and reads the next block behind them.
+// Returns the number of bytes read, 0 at the end of input.
+size_t refillInput(Input* input, size_t keep);
+
+#endif  // HEADER_INPUT
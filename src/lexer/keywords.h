@@ -19,6 +19,30 @@ static const char* OR    = "or";
 static const char* RET   = "ret";
 static const char* WHILE = "while";
 static const char* USE   = "use";
+static const char* NOT   = "not";
+
+typedef enum Keyword
+{
+    KWNone,
+    KWAnd,
+    KWAs,
+    KWDat,
+    KWElif,
+    KWElse,
+    KWEnd,
+    KWFor,
+    KWFun,
+    KWIf,
+    KWIn,
+    KWIs,
+    KWMod,
+    KWOr,
+    KWRet,
+    KWWhile,
+    KWUse,
+    KWNot,
+    KWCount
+} Keyword;
 
 bool isKeyword(const char* word);
 
@@ -1,13 +1,20 @@
 #include "lexer.h"
-#include "keywords.h"
-#include "types.h"
+#include "dfa.h"
+#include "number.h"
+#include "reserved.h"
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
+CharClass classOf(int c)
+{
+    return c == EOF ? CCEnd : (CharClass)charClasses[(unsigned char)c];
+}
+
 bool isNumeric(char c)
 {
-    return c >= SYMZero && c <= SYMNine;
+    return charClasses[(unsigned char)c] == CCDigit;
 }
 
 bool isHexDigit(char c)
@@ -15,6 +22,11 @@ bool isHexDigit(char c)
     return isNumeric(c) || (c >= SYMBigA && c <= SYMBigF);
 }
 
+unsigned hexValue(char c)
+{
+    return isNumeric(c) ? (unsigned)(c - SYMZero) : (unsigned)(c - SYMBigA + 10);
+}
+
 bool isBinaryDigit(char c)
 {
     return c == SYMZero || c == SYMOne;
@@ -32,283 +44,393 @@ bool isBigAlpha(char c)
 
 bool isAlpha(char c)
 {
-    return isSmallAlpha(c) || isBigAlpha(c);
+    return charClasses[(unsigned char)c] == CCAlpha;
 }
 
 bool isAlphaNumeric(char c)
 {
-    return isAlpha(c) || isNumeric(c);
+    CharClass cc = charClasses[(unsigned char)c];
+    return cc == CCAlpha || cc == CCDigit;
 }
 
 bool isHardTokenSeparator(char c)
 {
-    return c == SYMSpace || c == SYMNewline;
+    return c == SYMSpace || c == SYMNewline || c == SYMCarriageReturn;
 }
 
 bool isBoolean(const char* word)
 {
-    return strcmp(word, "true") == 0 || strcmp(word, "false") == 0;
+    unsigned id;
+    return classifyWord(word, strlen(word), &id) == TKBooleanConstant;
 }
 
 bool isNil(const char* word)
 {
-    return strcmp(word, "nil") == 0;
+    unsigned id;
+    return classifyWord(word, strlen(word), &id) == TKNilConstant;
 }
 
 bool isNop(const char* word)
 {
-    return strcmp(word, "nop") == 0;
+    unsigned id;
+    return classifyWord(word, strlen(word), &id) == TKNop;
 }
 
 bool isAsm(const char* word)
 {
-    return strcmp(word, "asm") == 0;
+    unsigned id;
+    return classifyWord(word, strlen(word), &id) == TKAsm;
 }
 
 /*
- * Buffer manipulation
+ * Private lexer helpers
  */
 
-char* append(char* buffer, char c)
+bool refill(Lexer* lexer)
 {
-    unsigned len    = strlen(buffer);
-    buffer[len]     = c;
-    buffer[len + 1] = '\0';
-    return buffer;
-}
+    // Keep the last block so the current token stays in the window
+    size_t pending = lexer->limit - lexer->start;
+    size_t read    = refillInput(&lexer->input, INPUT_BLOCK_SIZE);
+    lexer->limit   = lexer->input.data + lexer->input.size;
+    lexer->cursor  = lexer->limit - read;
+
+    // The current token has to fit into the kept block
+    if(pending > (size_t)(lexer->cursor - lexer->input.data))
+    {
+        lexer->truncated = true;
+        lexer->start     = lexer->input.data;
+    }
+    else
+    {
+        lexer->start = lexer->cursor - pending;
+    }
 
-/*
- * Private lexer helpers
- */
+    return read > 0;
+}
 
-void next(Lexer* lexer)
+// Makes 'c' the character at the cursor without consuming it
+void peek(Lexer* lexer)
 {
-    lexer->c = fgetc(lexer->input);
-    append(lexer->dbgLine, lexer->c);
-    lexer->col++;
+    if(lexer->cursor == lexer->limit && !refill(lexer))
+        lexer->c = EOF;
+    else
+        lexer->c = (unsigned char)*lexer->cursor;
 }
 
-void previous(Lexer* lexer)
+void next(Lexer* lexer)
 {
-    fseek(lexer->input, -1, SEEK_CUR);
-    lexer->dbgLine[strlen(lexer->dbgLine) - 1] = '\0';
-    lexer->col--;
+    if(lexer->c == EOF)
+        return;
+
+    lexer->cursor++;
+    peek(lexer);
 }
 
 Token eatToken(Lexer* lexer, Token tok)
 {
-    append(lexer->word, lexer->c);
+    next(lexer);
     lexer->tok = tok;
     return lexer->tok;
 }
 
 void consumeChar(Lexer* lexer)
 {
-    append(lexer->word, lexer->c);
     next(lexer);
 }
 
-/*
- * Lexer functions
- */
+// Consumes everything up to 'end' within the current window
+void consumeRun(Lexer* lexer, const char* end)
+{
+    lexer->cursor = end;
+    peek(lexer);
+}
+
+// Last consumed character of the current token
+char lastTokenChar(Lexer* lexer)
+{
+    return lexer->cursor > lexer->start ? lexer->cursor[-1] : '\0';
+}
 
-bool initializeLexer(Lexer* lexer, const char* filename)
+void resetLexer(Lexer* lexer, Interner* interner)
 {
     lexer->tok                           = TKUndefined;
     lexer->c                             = '\0';
-    lexer->col                           = 0;
-    lexer->line                          = 1;
-    lexer->context.isComment             = false;
+    lexer->flags                         = 0;
+    lexer->value                         = 0;
+    lexer->truncated                     = false;
     lexer->context.isBlockComment        = false;
-    lexer->context.lastIsComment         = false;
     lexer->context.floatPeriodRead       = false;
     lexer->context.lastIsSingleQuote     = false;
     lexer->context.lastIsDigit           = false;
     lexer->context.lastIsExponent        = false;
     lexer->context.floatExponentRead     = false;
     lexer->context.floatExponentSignRead = false;
+    initializeLineIndex(&lexer->lines);
+    initializeArena(&lexer->strings, 0);
+    lexer->interner = interner;
+    lexer->deferred = NULL;
+    lexer->messages = NULL;
+}
 
-    return fopen_s(&lexer->input, filename, "r");
+void startLexer(Lexer* lexer)
+{
+    lexer->cursor = lexer->input.data;
+    lexer->limit  = lexer->input.data + lexer->input.size;
+    lexer->start  = lexer->cursor;
+    lexer->scan   = selectScanners();
+    peek(lexer);
+}
+
+/*
+ * Lexer functions
+ */
+
+bool initializeLexer(Lexer* lexer, const char* filename, Interner* interner)
+{
+    resetLexer(lexer, interner);
+    bool opened = openInput(&lexer->input, filename);
+    startLexer(lexer);
+    return opened;
+}
+
+bool initializeLexerMemory(Lexer* lexer, const char* data, size_t size, size_t base, Interner* interner)
+{
+    resetLexer(lexer, interner);
+    borrowInput(&lexer->input, data, size, base);
+    startLexer(lexer);
+    return true;
 }
 
 bool finalizeLexer(Lexer* lexer)
 {
-    return fclose(lexer->input);
+    lexer->cursor = NULL;
+    lexer->limit  = NULL;
+    lexer->start  = NULL;
+    finalizeLineIndex(&lexer->lines);
+    finalizeArena(&lexer->strings);
+    return closeInput(&lexer->input);
 }
 
+Token scanToken(Lexer* lexer);
+
 Token tokenize(Lexer* lexer)
+{
+    lexer->truncated = false;
+
+    Token tok = scanToken(lexer);
+
+    if(lexer->truncated)
+        return lexError(lexer, "Token does not fit into the input window of %d bytes", INPUT_BLOCK_SIZE);
+
+    return tok;
+}
+
+bool tokenizeAll(Lexer* lexer, TokenStream* stream)
+{
+    // Spans need the whole source in memory
+    initializeTokenStream(stream, lexer->input.data, lexer->input.size / 4);
+    if(lexer->input.mode != InputMapped)
+        return false;
+
+    // Token offsets are 32 bits
+    if(lexer->input.size > UINT32_MAX)
+    {
+        lexError(lexer, "File too large, sources end at 4 GB");
+        return false;
+    }
+
+    for(;;)
+    {
+        Token  tok    = tokenize(lexer);
+        Lexeme lexeme = currentLexeme(lexer);
+        if(!pushToken(stream, &lexeme))
+        {
+            stream->count = 0;
+            lexError(lexer, "Out of memory");
+            return false;
+        }
+
+        if(tok == TKEnd || tok == TKInvalid)
+            return tok == TKEnd;
+    }
+}
+
+Lexeme currentLexeme(const Lexer* lexer)
+{
+    Lexeme lexeme;
+    lexeme.tok    = lexer->tok;
+    lexeme.flags  = lexer->flags;
+    lexeme.value  = lexer->value;
+    lexeme.offset = lexer->input.base + (size_t)(lexer->start - lexer->input.data);
+    lexeme.length = (unsigned)(lexer->cursor - lexer->start);
+    lexeme.text   = lexer->start;
+    return lexeme;
+}
+
+Token scanToken(Lexer* lexer)
 {
     lexer->tok                           = TKUndefined;
+    lexer->value                         = 0;
     lexer->context.floatPeriodRead       = false;
     lexer->context.lastIsSingleQuote     = false;
     lexer->context.lastIsDigit           = false;
     lexer->context.lastIsExponent        = false;
     lexer->context.floatExponentRead     = false;
     lexer->context.floatExponentSignRead = false;
-    memset(lexer->word, 0, MAX_IDENTIFIER_LENGTH);
 
-    next(lexer);
+    skipTrivia(lexer);
 
-    while(lexer->c != EOF)
+    lexer->start = lexer->cursor;
+
+    if(lexer->c == EOF)
     {
-        if(lexer->c == SYMNewline)
-        {
-            lexer->context.isComment = false;
+        lexer->tok = TKEnd;
+        return lexer->tok;
+    }
 
-            lexer->col = 0;
-            lexer->line += 1;
-            memset(lexer->dbgLine, 0, LINE_LENGTH);
-            lexer->tok = TKEmpty;
-            return lexer->tok;
+    // Longest match through the transition table, identifiers and constants are handed off
+    DFAState state = DFAStart;
+    for(;;)
+    {
+        DFAState following = dfaTransitions[state][classOf(lexer->c)];
+
+        if(following == DFAStop)
+            break;
+        else if(following == DFAIdentifier)
+            return tokenizeIdentifier(lexer);
+        else if(following == DFANumber)
+            return tokenizeNumericConstant(lexer);
+        else if(following == DFAString)
+            return tokenizeStringConstant(lexer);
+        else if(following == DFACharacter)
+            return tokenizeCharacterConstant(lexer);
+
+        state = following;
+        next(lexer);
+    }
+
+    if(state == DFAStart)
+    {
+        lexError(lexer, "Unkwon symbol");
+        next(lexer);
+        return lexer->tok;
+    }
+
+    lexer->tok = (Token)dfaAccepts[state];
+    return lexer->tok;
+}
+
+/*
+ * Trivia
+ */
+
+// Consumes everything up to 'end' within the current window, including line breaks
+void skipTo(Lexer* lexer, const char* end)
+{
+    // Trivia never has to stay in the window
+    lexer->start = end;
+    consumeRun(lexer, end);
+}
+
+void skipTrivia(Lexer* lexer)
+{
+    lexer->flags = 0;
+
+    if(lexer->context.isBlockComment)
+    {
+        lexer->flags |= TKFlagComment;
+        skipBlockComment(lexer);
+    }
+
+    for(;;)
+    {
+        lexer->start = lexer->cursor;
+
+        if(lexer->c == SYMSpace || lexer->c == SYMCarriageReturn)
+        {
+            lexer->flags |= TKFlagSpace;
+            skipTo(lexer, lexer->scan->spaces(lexer->cursor, lexer->limit));
+        }
+        else if(lexer->c == SYMNewline)
+        {
+            lexer->flags |= TKFlagNewline;
+            skipTo(lexer, lexer->cursor + 1);
         }
         else if(lexer->c == SYMNumberSign)
         {
-            // Block comment handling
-            if(lexer->context.lastIsComment)
+            lexer->flags |= TKFlagComment;
+            skipTo(lexer, lexer->cursor + 1);
+
+            if(lexer->c == SYMNumberSign)
             {
-                if(lexer->context.isBlockComment)
-                    lexer->context.isBlockComment = false;
-                else
-                    lexer->context.isBlockComment = true;
+                skipTo(lexer, lexer->cursor + 1);
+                lexer->context.isBlockComment = true;
+                skipBlockComment(lexer);
             }
-            // Single line comment
             else
             {
-                lexer->context.isComment = true;
+                skipLineComment(lexer);
             }
-
-            lexer->context.lastIsComment = true;
-
-            return eatToken(lexer, TKComment);
         }
+        else
+        {
+            return;
+        }
+    }
+}
 
-        lexer->context.lastIsComment = false;
+void skipLineComment(Lexer* lexer)
+{
+    while(lexer->c != EOF && lexer->c != SYMNewline)
+    {
+        const char* newline = memchr(lexer->cursor, SYMNewline, lexer->limit - lexer->cursor);
+        skipTo(lexer, newline != NULL ? newline : lexer->limit);
+    }
+}
 
-        if(lexer->context.isComment || lexer->context.isBlockComment)
+void skipBlockComment(Lexer* lexer)
+{
+    // A '#' at the end of the window is paired after the refill
+    while(lexer->c != EOF)
+    {
+        const char* sign = memchr(lexer->cursor, SYMNumberSign, lexer->limit - lexer->cursor);
+        if(sign == NULL)
         {
-            lexer->tok = TKComment;
-            return lexer->tok;
+            skipTo(lexer, lexer->limit);
+            continue;
         }
 
-        switch(lexer->c)
-        {
-            // Valid control characters
-            case SYMAtSign:
-            case SYMDollarSign:
-            case SYMPeriod:
-                return eatToken(lexer, TKUndefined);
-
-            case SYMEqualSign:
-                return eatToken(lexer, TKAssignment);
-
-            // Operator characters
-            case SYMAsterisk:
-                return eatToken(lexer, TKOperatorMultiplication);
-            case SYMSlash:
-                return eatToken(lexer, TKOperatorDivision);
-            case SYMPlusSign:
-                return eatToken(lexer, TKOperatorAddition);
-            case SYMMinusSign:
-                return eatToken(lexer, TKOperatorDivision);
-            case SYMPercentSign:
-                return eatToken(lexer, TKOperatorModulo);
-            case SYMAmpersand:
-                return eatToken(lexer, TKOperatorAND);
-            case SYMVerticalBar:
-                return eatToken(lexer, TKOperatorOR);
-            case SYMCircumflex:
-                return eatToken(lexer, TKOperatorXOR);
-            case SYMTilde:
-                return eatToken(lexer, TKOperatorCOMP);
-            case SYMGreaterThanSign:
-                return eatToken(lexer, TKOperatorGreaterThan);
-            case SYMLessThanSign:
-                return eatToken(lexer, TKOperatorLessThan);
-
-            // String constant
-            case SYMDoubleQuote:
-                return eatToken(lexer, TKStringBorder);
-
-            // Character constant
-            case SYMSingleQuote:
-                return eatToken(lexer, TKCharacterBorder);
-
-            // Block
-            case SYMCurlyBracesOpen:
-                return eatToken(lexer, TKBlockBegin);
-            case SYMCurlyBracesClose:
-                return eatToken(lexer, TKBlockEnd);
-
-            // Expression
-            case SYMParenthesisOpen:
-                return eatToken(lexer, TKExpressionBegin);
-            case SYMParenthesisClose:
-                return eatToken(lexer, TKExpressionEnd);
-
-            // Separators
-            case SYMComma:
-                return eatToken(lexer, TKCommaSeparator);
-            case SYMColon:
-                return eatToken(lexer, TKColonSeparator);
-
-            // Slice
-            case SYMBracketOpen:
-                return eatToken(lexer, TKSliceBegin);
-            case SYMBracketClose:
-                return eatToken(lexer, TKSliceBegin);
-
-            // Hard Token separation
-            case SYMSpace:
-                lexer->tok = TKEmpty;
-                return lexer->tok;
+        skipTo(lexer, sign + 1);
 
-            default:
-                if(isAlphaNumeric(lexer->c))
-                {
-                    if(lexer->tok == TKUndefined)
-                    {
-                        if(isNumeric(lexer->c))
-                            return tokenizeNumericConstant(lexer);
-                        else
-                            return tokenizeIdentifier(lexer);
-                    }
-                }
-                else
-                {
-                    return lexError(lexer, "Unkwon symbol");
-                }
+        if(lexer->c == SYMNumberSign)
+        {
+            skipTo(lexer, lexer->cursor + 1);
+            lexer->context.isBlockComment = false;
+            return;
         }
-
-        next(lexer);
     }
-
-    lexer->tok = TKEnd;
-    return lexer->tok;
 }
 
 Token tokenizeIdentifier(Lexer* lexer)
 {
     lexer->tok = TKIdentifier;
 
-    consumeChar(lexer);
-
     while(isAlphaNumeric(lexer->c))
-        consumeChar(lexer);
+        consumeRun(lexer, lexer->scan->identifier(lexer->cursor, lexer->limit));
+
+    unsigned id;
+    size_t   length = lexer->cursor - lexer->start;
+    lexer->tok      = classifyWord(lexer->start, length, &id);
+    lexer->value    = id;
+
+    // Later stages compare names by symbol id only
+    if(lexer->tok == TKIdentifier)
+    {
+        lexer->value = intern(lexer->interner, lexer->start, length);
+        if(lexer->value == SYMBOL_NONE)
+            return lexError(lexer, "Out of memory for identifiers");
+    }
 
-    if(isKeyword(lexer->word))
-        lexer->tok = TKKeyword;
-    else if(isType(lexer->word))
-        lexer->tok = TKType;
-    else if(isBoolean(lexer->word))
-        lexer->tok = TKBooleanConstant;
-    else if(isNil(lexer->word))
-        lexer->tok = TKNilConstant;
-    else if(isNop(lexer->word))
-        lexer->tok = TKNop;
-    else if(isAsm(lexer->word))
-        lexer->tok = TKAsm;
-
-    previous(lexer);
     return lexer->tok;
 }
 
@@ -328,10 +450,8 @@ bool isNumberSeparatorAtStart(Lexer* lexer)
 
 bool isNumberSeparatorAtEnd(Lexer* lexer)
 {
-    if(lexer->word[strlen(lexer->word) - 1] == SYMSingleQuote)
+    if(lastTokenChar(lexer) == SYMSingleQuote)
     {
-        lexer->c = lexer->word[strlen(lexer->word) - 1];
-        previous(lexer);
         lexError(lexer, "Digit separators at end of number");
         return true;
     }
@@ -371,10 +491,28 @@ Token tokenizeNumericConstant(Lexer* lexer)
         lexer->tok = tokenizeHexadecimalConstant(lexer);
     else if(isNumeric(lexer->c) || lexer->c == SYMPeriod || lexer->c == SYMSingleQuote)
         lexer->tok = tokenizeDecimalOrFloatConstant(lexer);
-    else if(lexer->c == EOF || lexer->c == SYMNewline || lexer->c == SYMSpace)
-        lexer->tok = TKDecimalConstant;
     else
-        previous(lexer);
+        lexer->tok = TKDecimalConstant;
+
+    if(lexer->tok == TKInvalid)
+        return lexer->tok;
+
+    // Decode right away while the digits are still in the cache
+    const char* text   = lexer->start;
+    size_t      length = lexer->cursor - lexer->start;
+    bool        fits   = true;
+
+    if(lexer->tok == TKBinaryConstant)
+        fits = decodeBinary(text + 2, length - 2, &lexer->value);
+    else if(lexer->tok == TKHexadecimalConstant)
+        fits = decodeHexadecimal(text + 2, length - 2, &lexer->value);
+    else if(lexer->tok == TKDecimalConstant)
+        fits = decodeDecimal(text, length, &lexer->value);
+    else if(lexer->tok == TKFloatConstant)
+        lexer->value = floatToBits(decodeFloat(text, length));
+
+    if(!fits)
+        return lexError(lexer, "Numeric constant does not fit into 64 bits");
 
     return lexer->tok;
 }
@@ -398,7 +536,10 @@ Token tokenizeBinaryConstant(Lexer* lexer)
             return lexer->tok;
         }
 
-        consumeChar(lexer);
+        if(lexer->c == SYMSingleQuote)
+            consumeChar(lexer);
+        else
+            consumeRun(lexer, lexer->scan->binaryDigits(lexer->cursor, lexer->limit));
     }
 
     if(isNumberSeparatorAtEnd(lexer))
@@ -406,7 +547,6 @@ Token tokenizeBinaryConstant(Lexer* lexer)
         return lexer->tok;
     }
 
-    previous(lexer);
     return lexer->tok;
 }
 
@@ -429,7 +569,10 @@ Token tokenizeHexadecimalConstant(Lexer* lexer)
             return lexer->tok;
         }
 
-        consumeChar(lexer);
+        if(lexer->c == SYMSingleQuote)
+            consumeChar(lexer);
+        else
+            consumeRun(lexer, lexer->scan->hexDigits(lexer->cursor, lexer->limit));
     }
 
     if(isNumberSeparatorAtEnd(lexer))
@@ -437,7 +580,6 @@ Token tokenizeHexadecimalConstant(Lexer* lexer)
         return lexer->tok;
     }
 
-    previous(lexer);
     return lexer->tok;
 }
 
@@ -445,8 +587,10 @@ Token tokenizeDecimalOrFloatConstant(Lexer* lexer)
 {
     lexer->tok = TKDecimalConstant;
 
+    // Signs only belong to the number right after the exponent
     while(isNumeric(lexer->c) || lexer->c == SYMPeriod || lexer->c == SYMSingleQuote ||
-          lexer->c == SYMSmallE || lexer->c == SYMPlusSign || lexer->c == SYMMinusSign)
+          lexer->c == SYMSmallE ||
+          ((lexer->c == SYMPlusSign || lexer->c == SYMMinusSign) && lexer->context.lastIsExponent))
     {
         if(lexer->c == SYMPeriod)
         {
@@ -508,7 +652,13 @@ Token tokenizeDecimalOrFloatConstant(Lexer* lexer)
         }
         else
         {
-            lexer->context.lastIsDigit = true;
+            // Whole digit runs at once
+            lexer->context.lastIsDigit       = true;
+            lexer->context.lastIsSingleQuote = false;
+            lexer->context.lastIsExponent    = false;
+
+            consumeRun(lexer, lexer->scan->digits(lexer->cursor, lexer->limit));
+            continue;
         }
 
         if(!isNumeric(lexer->c))
@@ -524,36 +674,334 @@ Token tokenizeDecimalOrFloatConstant(Lexer* lexer)
     if(isNumberSeparatorAtEnd(lexer))
         return lexer->tok;
 
-    previous(lexer);
     return lexer->tok;
 }
 
+/*
+ * Tokenizing string and character constants
+ */
+
+// Consumes the contents and the closing quote, false if the constant is not terminated
+bool consumeQuoted(Lexer* lexer, char quote, ScanFunction scan, bool* escaped)
+{
+    // Opening quote
+    consumeChar(lexer);
+
+    *escaped = false;
+    for(;;)
+    {
+        // Everything up to the next quote or backslash at once
+        consumeRun(lexer, scan(lexer->cursor, lexer->limit));
+
+        if(lexer->c == quote)
+            break;
+        if(lexer->c == EOF || lexer->c == SYMNewline)
+            return false;
+
+        // Otherwise the run only stopped at the end of the window
+        if(lexer->c == SYMBackslash)
+        {
+            // Backslash and the escaped character, validated when decoding
+            *escaped = true;
+            consumeChar(lexer);
+            if(lexer->c == EOF || lexer->c == SYMNewline)
+                return false;
+            consumeChar(lexer);
+        }
+    }
+
+    // Closing quote
+    consumeChar(lexer);
+    return true;
+}
+
+// Decodes the escape sequence behind a backslash, -1 for unknown ones
+int decodeEscape(const char** p, const char* end)
+{
+    char c = *(*p)++;
+    switch(c)
+    {
+        case SYMSmallN:
+            return SYMNewline;
+        case SYMSmallR:
+            return SYMCarriageReturn;
+        case SYMSmallT:
+            return '\t';
+        case SYMZero:
+            return '\0';
+
+        case SYMBackslash:
+        case SYMDoubleQuote:
+        case SYMSingleQuote:
+            return c;
+
+        case SYMSmallX:
+            if(end - *p < 2 || !isHexDigit((*p)[0]) || !isHexDigit((*p)[1]))
+                return -1;
+            *p += 2;
+            return (int)hexValue((*p)[-2]) << 4 | (int)hexValue((*p)[-1]);
+
+        default:
+            return -1;
+    }
+}
+
+// Code point of the UTF-8 sequence at 'p', -1 if it is malformed
+int decodeCodePoint(const char** p, const char* end)
+{
+    unsigned char lead = (unsigned char)*(*p)++;
+    if(lead < 0x80)
+        return lead;
+
+    int count = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+    if(count < 0 || end - *p < count)
+        return -1;
+
+    int code = lead & (0x3F >> count);
+    while(count-- > 0)
+    {
+        unsigned char c = (unsigned char)*(*p)++;
+        if((c & 0xC0) != 0x80)
+            return -1;
+        code = code << 6 | (c & 0x3F);
+    }
+    return code;
+}
+
+Token decodeStringConstant(Lexer* lexer)
+{
+    // Decoded text is never longer than the source, its length goes in front
+    const char* p      = lexer->start + 1;
+    const char* end    = lexer->cursor - 1;
+    size_t      offset = allocateArena(&lexer->strings, sizeof(uint32_t) + (end - p), sizeof(uint32_t));
+    if(offset == ARENA_FAILED)
+        return lexError(lexer, "Out of memory for string constants");
+
+    char*    text   = (char*)arenaAt(&lexer->strings, offset) + sizeof(uint32_t);
+    uint32_t length = 0;
+    while(p < end)
+    {
+        const char* escape = memchr(p, SYMBackslash, end - p);
+        size_t      plain  = (escape != NULL ? escape : end) - p;
+
+        memcpy(text + length, p, plain);
+        length += plain;
+        p += plain;
+        if(p == end)
+            break;
+
+        // '\'
+        p++;
+        int c = decodeEscape(&p, end);
+        if(c < 0)
+            return lexError(lexer, "Unknown escape sequence in string constant");
+        text[length++] = (char)c;
+    }
+
+    // Give back what the escapes saved
+    memcpy(text - sizeof(uint32_t), &length, sizeof(length));
+    lexer->strings.size = offset + sizeof(uint32_t) + length;
+
+    lexer->flags |= TKFlagEscaped;
+    lexer->value = offset;
+    return lexer->tok;
+}
+
+Token tokenizeStringConstant(Lexer* lexer)
+{
+    lexer->tok = TKStringConstant;
+
+    bool escaped;
+    if(!consumeQuoted(lexer, SYMDoubleQuote, lexer->scan->string, &escaped))
+        return lexError(lexer, "Unterminated string constant");
+
+    // Strings without escapes stay a span into the source
+    if(escaped)
+        return decodeStringConstant(lexer);
+
+    return lexer->tok;
+}
+
+Token tokenizeCharacterConstant(Lexer* lexer)
+{
+    lexer->tok = TKCharacterConstant;
+
+    bool escaped;
+    if(!consumeQuoted(lexer, SYMSingleQuote, lexer->scan->character, &escaped))
+        return lexError(lexer, "Unterminated character constant");
+
+    const char* p   = lexer->start + 1;
+    const char* end = lexer->cursor - 1;
+    if(p == end)
+        return lexError(lexer, "Empty character constant");
+
+    int c;
+    if(*p == SYMBackslash)
+    {
+        p++;
+        c = decodeEscape(&p, end);
+    }
+    else
+    {
+        c = decodeCodePoint(&p, end);
+    }
+
+    if(c < 0)
+        return lexError(lexer, "Invalid character constant");
+    if(p != end)
+        return lexError(lexer, "Multiple characters in character constant");
+
+    // The value is the code point
+    lexer->value = (uint64_t)c;
+    return lexer->tok;
+}
+
+const char* stringConstant(const Lexer* lexer, const Lexeme* lexeme, unsigned* length)
+{
+    if(lexeme->flags & TKFlagEscaped)
+    {
+        const char* text = arenaAt(&lexer->strings, (size_t)lexeme->value);
+        uint32_t    size;
+        memcpy(&size, text, sizeof(size));
+        *length = size;
+        return text + sizeof(uint32_t);
+    }
+
+    *length = lexeme->length - 2;
+    return lexeme->text + 1;
+}
+
 /*
  * Helper
  */
 
-Token lexError(Lexer* lexer, const char* fmt, ...)
+Location locate(Lexer* lexer, size_t offset)
+{
+    Input*      input = &lexer->input;
+    const char* data  = input->data;
+    const char* end   = data + input->size;
+    size_t      line;
+    size_t      lineStart;
+
+    if(input->mode == InputMapped)
+    {
+        // Borrowed inputs count lines from their first byte
+        line      = findLine(&lexer->lines, data, input->size, offset - input->base);
+        lineStart = input->base + (lexer->lines.count > 0 ? lexer->lines.starts[line] : 0);
+    }
+    else
+    {
+        // Only the window is left, the lines in front of it are counted while refilling
+        line      = input->lines;
+        lineStart = input->lineStart;
+
+        const char* found = data;
+        const char* at    = data + (offset - input->base);
+        while((found = memchr(found, SYMNewline, at - found)) != NULL)
+        {
+            found++;
+            line++;
+            lineStart = input->base + (size_t)(found - data);
+        }
+    }
+
+    const char* text  = data + (lineStart > input->base ? lineStart - input->base : 0);
+    const char* found = memchr(text, SYMNewline, end - text);
+    const char* stop  = found != NULL ? found : end;
+    if(stop > text && stop[-1] == '\r')
+        stop--;
+
+    Location location;
+    location.line   = (unsigned)line + 1;
+    location.col    = (unsigned)(offset - lineStart) + 1;
+    location.text   = text;
+    location.length = (unsigned)(stop - text);
+    return location;
+}
+
+void printErrorV(Lexer* lexer, const char* fmt, va_list args)
 {
-    printf("\n");
+    if(lexer->messages != NULL)
+        appendTextV(lexer->messages, fmt, args);
+    else
+        vprintf(fmt, args);
+}
 
+void printError(Lexer* lexer, const char* fmt, ...)
+{
     va_list args;
     va_start(args, fmt);
-    vprintf(fmt, args);
+    printErrorV(lexer, fmt, args);
     va_end(args);
+}
 
-    printf(" while lexing token '\33[33m%s\033[0m'", tokenToString(lexer->tok));
-    printf(
-        " in line \33[36m%d\033[0m at position \033[36m%d\033[0m: '\33[31m%c\033[0m'\n\n",
-        lexer->line,
-        lexer->col,
-        lexer->c);
-    printf("%*c%s\n", 10, ' ', lexer->dbgLine);
-    printf("%*c\n\n", 10 + lexer->col, '^');
+// Names the token being lexed unless 'lexing' is false, for errors found later
+void reportError(Lexer* lexer, bool lexing, Token tok, size_t offset, const char* fmt, va_list args)
+{
+    if(lexer->deferred != NULL)
+    {
+        Diagnostic* diagnostic = lexer->deferred;
+        if(!diagnostic->set)
+        {
+            diagnostic->set    = true;
+            diagnostic->tok    = tok;
+            diagnostic->offset = offset;
+            vsnprintf(diagnostic->message, sizeof(diagnostic->message), fmt, args);
+        }
+        return;
+    }
+
+    Location location = locate(lexer, offset);
+
+    printError(lexer, "\n");
+    printErrorV(lexer, fmt, args);
+
+    if(lexing)
+        printError(lexer, " while lexing token '\33[33m%s\033[0m'", tokenToString(tok));
+    printError(
+        lexer,
+        " in line \33[36m%u\033[0m at position \033[36m%u\033[0m\n\n",
+        location.line,
+        location.col);
+    printError(lexer, "%*c%.*s\n", 10, ' ', location.length, location.text);
+    printError(lexer, "%*c\n\n", 10 + location.col, '^');
+}
+
+Token lexError(Lexer* lexer, const char* fmt, ...)
+{
+    size_t offset = lexer->input.base + (size_t)(lexer->cursor - lexer->input.data);
+
+    va_list args;
+    va_start(args, fmt);
+    reportError(lexer, true, lexer->tok, offset, fmt, args);
+    va_end(args);
 
     lexer->tok = TKInvalid;
     return lexer->tok;
 }
 
+void lexErrorAt(Lexer* lexer, const Lexeme* lexeme, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    reportError(lexer, true, lexeme->tok, lexeme->offset, fmt, args);
+    va_end(args);
+}
+
+void sourceErrorAt(Lexer* lexer, size_t offset, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    reportError(lexer, false, TKUndefined, offset, fmt, args);
+    va_end(args);
+}
+
+void reportDiagnostic(Lexer* lexer, const Diagnostic* diagnostic)
+{
+    Lexeme lexeme = {.tok = diagnostic->tok, .offset = diagnostic->offset};
+    lexErrorAt(lexer, &lexeme, "%s", diagnostic->message);
+}
+
 const char* tokenToString(Token tok)
 {
     switch(tok)
@@ -594,11 +1042,31 @@ const char* tokenToString(Token tok)
 
         case TKAssignment:
             return "TKAssignment";
-
+        case TKAssignmentMultiplication:
+            return "TKAssignmentMultiplication";
+        case TKAssignmentDivision:
+            return "TKAssignmentDivision";
+        case TKAssignmentAddition:
+            return "TKAssignmentAddition";
+        case TKAssignmentSubtraction:
+            return "TKAssignmentSubtraction";
+        case TKAssignmentModulo:
+            return "TKAssignmentModulo";
+        case TKAssignmentAND:
+            return "TKAssignmentAND";
+        case TKAssignmentOR:
+            return "TKAssignmentOR";
+        case TKAssignmentXOR:
+            return "TKAssignmentXOR";
+
+        case TKOperatorPower:
+            return "TKOperatorPower";
         case TKOperatorMultiplication:
             return "TKOperatorMultiplication";
         case TKOperatorDivision:
             return "TKOperatorDivision";
+        case TKOperatorFloorDivision:
+            return "TKOperatorFloorDivision";
         case TKOperatorAddition:
             return "TKOperatorAddition";
         case TKOperatorSubtraction:
@@ -613,15 +1081,21 @@ const char* tokenToString(Token tok)
             return "TKOperatorXOR";
         case TKOperatorCOMP:
             return "TKOperatorCOMP";
+        case TKOperatorEqual:
+            return "TKOperatorEqual";
         case TKOperatorGreaterThan:
             return "TKOperatorGreaterThan";
+        case TKOperatorGreaterEqual:
+            return "TKOperatorGreaterEqual";
         case TKOperatorLessThan:
             return "TKOperatorLessThan";
+        case TKOperatorLessEqual:
+            return "TKOperatorLessEqual";
 
-        case TKStringBorder:
-            return "TKStringBorder";
-        case TKCharacterBorder:
-            return "TKCharacterBorder";
+        case TKStringConstant:
+            return "TKStringConstant";
+        case TKCharacterConstant:
+            return "TKCharacterConstant";
 
         case TKBlockBegin:
             return "TKBlockBegin";
@@ -2,11 +2,20 @@
 #define HEADER_LEXER
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "input.h"
+#include "lines.h"
+#include "scan.h"
 #include "symbols.h"
+#include "tokenring.h"
+#include "tokenstream.h"
 #include "tokens.h"
+#include "../util/arena.h"
+#include "../util/interner.h"
+#include "../util/text.h"
 
 /*
  * Helper functions
@@ -36,21 +45,13 @@ bool isNop(const char* word);
 
 bool isAsm(const char* word);
 
-/*
- * Buffer manipulation
- */
-
-char* append(char* buffer, char c);
-
 /*
  * Lexer
  */
 
 typedef struct Context
 {
-    bool isComment;
     bool isBlockComment;
-    bool lastIsComment;
     bool lastIsSingleQuote;
     bool lastIsDigit;
     bool lastIsExponent;
@@ -59,27 +60,51 @@ typedef struct Context
     bool floatExponentSignRead;
 } Context;
 
-#define MAX_IDENTIFIER_LENGTH 255
-#define LINE_LENGTH 255
+// Error kept instead of printed, for lexers whose result may be thrown away
+typedef struct Diagnostic
+{
+    bool   set;
+    Token  tok;
+    size_t offset;
+    char   message[256];
+} Diagnostic;
 
 typedef struct Lexer
 {
-    FILE*    input;
-    unsigned col;
-    unsigned line;
-    char     dbgLine[LINE_LENGTH];
-    char     word[MAX_IDENTIFIER_LENGTH];
-    Token    tok;
-    char     c;
-    Context  context;
+    Input           input;
+    const Scanners* scan;
+    const char*     cursor;
+    const char*     limit;
+    const char*     start;  // Begin of the current token
+    LineIndex       lines;    // Built on demand by diagnostics
+    Arena           strings;  // Decoded string constants with escapes
+    Interner*       interner; // Identifiers, shared between lexers
+    Token           tok;
+    unsigned        flags;  // Trivia in front of the current token
+    uint64_t        value;  // Keyword, type or symbol id, constant value
+    int             c;      // Next unconsumed character or EOF
+    bool            truncated;
+    Context         context;
+    Diagnostic*     deferred;  // Takes the first error when set, nothing is printed
+    TextBuffer*     messages;  // Takes the printed errors when set
 } Lexer;
 
-bool initializeLexer(Lexer* lexer, const char* filename);
+bool initializeLexer(Lexer* lexer, const char* filename, Interner* interner);
+
+// Lexes memory owned by the caller, 'base' is the offset of data[0] in the whole source
+bool initializeLexerMemory(Lexer* lexer, const char* data, size_t size, size_t base, Interner* interner);
 
 bool finalizeLexer(Lexer* lexer);
 
 Token tokenize(Lexer* lexer);
 
+// Tokenizes a mapped input into 'stream' without copying any token text. Returns false
+// on a lexing error, whose TKInvalid ends the stream, or if the stream could not be built,
+// which is reported and leaves it empty. Streamed inputs are left to tokenize.
+bool tokenizeAll(Lexer* lexer, TokenStream* stream);
+
+Lexeme currentLexeme(const Lexer* lexer);
+
 /*
  * Tokenizing constant values
  */
@@ -90,6 +115,20 @@ bool isNumberSeparatorAtEnd(Lexer* lexer);
 
 bool isNumberSeparatorDuplication(Lexer* lexer);
 
+/*
+ * Trivia
+ */
+
+void skipTrivia(Lexer* lexer);
+
+void skipLineComment(Lexer* lexer);
+
+void skipBlockComment(Lexer* lexer);
+
+/*
+ * Tokenizing
+ */
+
 Token tokenizeIdentifier(Lexer* lexer);
 
 Token tokenizeNumericConstant(Lexer* lexer);
@@ -100,12 +139,39 @@ Token tokenizeHexadecimalConstant(Lexer* lexer);
 
 Token tokenizeDecimalOrFloatConstant(Lexer* lexer);
 
+Token tokenizeStringConstant(Lexer* lexer);
+
+Token tokenizeCharacterConstant(Lexer* lexer);
+
+// Contents of a string constant without the quotes, decoded if it has escapes
+const char* stringConstant(const Lexer* lexer, const Lexeme* lexeme, unsigned* length);
+
 /*
  * Helper
  */
 
+// Line and column are only computed here, from the offset
+typedef struct Location
+{
+    unsigned    line;
+    unsigned    col;
+    const char* text;    // Source line containing the offset
+    unsigned    length;  // Without the line break
+} Location;
+
+Location locate(Lexer* lexer, size_t offset);
+
 Token lexError(Lexer* lexer, const char* fmt, ...);
 
+// Reports an error at a token that was already tokenized
+void lexErrorAt(Lexer* lexer, const Lexeme* lexeme, const char* fmt, ...);
+
+// Reports an error found after lexing, such as an unknown module, at a source offset
+void sourceErrorAt(Lexer* lexer, size_t offset, const char* fmt, ...);
+
+// Prints a deferred error, 'lexer' has to read the source it was found in
+void reportDiagnostic(Lexer* lexer, const Diagnostic* diagnostic);
+
 const char* tokenToString(Token tok);
 
 #endif  // HEADER_LEXER
\ No newline at end of file
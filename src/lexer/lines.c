@@ -0,0 +1,107 @@
+#include "lines.h"
+#include "symbols.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Private helpers
+ */
+
+bool addLineStart(LineIndex* index, size_t offset)
+{
+    if(index->count == index->capacity)
+    {
+        size_t  capacity = index->capacity > 0 ? index->capacity * 2 : 256;
+        size_t* starts   = realloc(index->starts, capacity * sizeof(size_t));
+        if(starts == NULL)
+            return false;
+
+        index->starts   = starts;
+        index->capacity = capacity;
+    }
+
+    index->starts[index->count++] = offset;
+    return true;
+}
+
+void extendLineIndex(LineIndex* index, const char* source, size_t size, size_t offset)
+{
+    if(index->count == 0 && !addLineStart(index, 0))
+        return;
+
+    while(index->scanned <= offset && index->scanned < size)
+    {
+        const char* from  = source + index->scanned;
+        const char* found = memchr(from, SYMNewline, size - index->scanned);
+        if(found == NULL)
+        {
+            index->scanned = size;
+            return;
+        }
+
+        index->scanned = (size_t)(found - source) + 1;
+        if(!addLineStart(index, index->scanned))
+            return;
+    }
+}
+
+/*
+ * Line index
+ */
+
+void initializeLineIndex(LineIndex* index)
+{
+    index->starts   = NULL;
+    index->count    = 0;
+    index->capacity = 0;
+    index->scanned  = 0;
+}
+
+void finalizeLineIndex(LineIndex* index)
+{
+    free(index->starts);
+    initializeLineIndex(index);
+}
+
+size_t findLine(LineIndex* index, const char* source, size_t size, size_t offset)
+{
+    extendLineIndex(index, source, size, offset);
+    if(index->count == 0)
+        return 0;
+
+    // Last line start at or before 'offset'
+    size_t low  = 0;
+    size_t high = index->count;
+    while(high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(index->starts[middle] <= offset)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+void truncateLineIndex(LineIndex* index, size_t offset)
+{
+    if(index->scanned <= offset)
+        return;
+
+    // Lines up to the one containing 'offset' stay, its end is searched again
+    size_t low  = 0;
+    size_t high = index->count;
+    while(high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(index->starts[middle] <= offset)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    index->count   = index->count > 0 ? low + 1 : 0;
+    index->scanned = index->count > 0 ? index->starts[low] : 0;
+}
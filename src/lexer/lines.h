@@ -0,0 +1,29 @@
+#ifndef HEADER_LINES
+#define HEADER_LINES
+
+#include <stddef.h>
+
+/*
+ * Line index
+ */
+
+// Offsets of line starts, only built as far as a lookup needs it
+typedef struct LineIndex
+{
+    size_t* starts;
+    size_t  count;
+    size_t  capacity;
+    size_t  scanned;  // Source bytes already searched for line breaks
+} LineIndex;
+
+void initializeLineIndex(LineIndex* index);
+
+void finalizeLineIndex(LineIndex* index);
+
+// Zero based line containing 'offset'
+size_t findLine(LineIndex* index, const char* source, size_t size, size_t offset);
+
+// Forgets the line breaks from 'offset' on, for sources changed there
+void truncateLineIndex(LineIndex* index, size_t offset);
+
+#endif  // HEADER_LINES
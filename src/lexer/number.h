@@ -0,0 +1,28 @@
+#ifndef HEADER_NUMBER
+#define HEADER_NUMBER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Numeric constants
+ */
+
+// Text may contain digit separators, returns false if the value does not fit into 64 bits
+bool decodeDecimal(const char* text, size_t length, uint64_t* value);
+
+// Text without the leading '0b' or '0x'
+bool decodeBinary(const char* text, size_t length, uint64_t* value);
+
+bool decodeHexadecimal(const char* text, size_t length, uint64_t* value);
+
+// Correctly rounded, too large values become infinity
+double decodeFloat(const char* text, size_t length);
+
+// Float constants keep the bits of their double value
+uint64_t floatToBits(double value);
+
+double bitsToFloat(uint64_t bits);
+
+#endif  // HEADER_NUMBER
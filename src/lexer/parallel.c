@@ -0,0 +1,371 @@
+#include "parallel.h"
+#include "../util/thread.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Chunk lexed from one of the two states it can start in
+typedef struct Speculation
+{
+    Lexer       lexer;  // Owns the decoded string constants
+    Interner    symbols;
+    Diagnostic  diagnostic;
+    TokenStream tokens;
+    size_t      resume;  // Token of the other speculation these continue with, SIZE_MAX if none
+    bool        endsInComment;
+    bool        used;
+    SymbolId*   symbolMap;   // Symbol ids of 'symbols' in the shared interner
+    size_t      stringBase;   // Offset of the string constants in the shared arena
+    size_t      stringFirst;  // Offset of the first one in use in the own arena
+} Speculation;
+
+typedef struct Chunk
+{
+    size_t      begin;
+    size_t      end;
+    Speculation speculations[2];  // Indexed by the block comment state at 'begin'
+
+    // Set by the join
+    Speculation* head;  // Tokens from the state the chunk really starts in
+    size_t       headCount;
+    Speculation* tail;  // Continuation after both states agree, or NULL
+    size_t       tailCount;
+    size_t       first;  // Index of the first token in the joined stream
+    unsigned     flags;  // Trivia of previous chunks in front of the first token
+} Chunk;
+
+typedef struct ParallelLexer
+{
+    Lexer*        lexer;
+    TokenStream*  stream;
+    Chunk*        chunks;
+    size_t        count;
+    atomic_size_t next;  // Next chunk to take by a worker
+} ParallelLexer;
+
+/*
+ * Private helpers
+ */
+
+void lexSpeculation(ParallelLexer* parallel, Chunk* chunk, bool inComment)
+{
+    Speculation* speculation = &chunk->speculations[inComment];
+    Speculation* other       = &chunk->speculations[false];
+    const char*  source      = parallel->lexer->input.data;
+    size_t       size        = chunk->end - chunk->begin;
+
+    speculation->used           = true;
+    speculation->resume         = SIZE_MAX;
+    speculation->symbolMap      = NULL;
+    speculation->stringBase     = 0;
+    speculation->stringFirst    = 0;
+    speculation->diagnostic.set = false;
+    initializeInterner(&speculation->symbols);
+    initializeTokenStream(&speculation->tokens, source, inComment ? 16 : size / 4);
+    initializeLexerMemory(&speculation->lexer, source + chunk->begin, size, chunk->begin, &speculation->symbols);
+    speculation->lexer.deferred               = &speculation->diagnostic;
+    speculation->lexer.context.isBlockComment = inComment;
+
+    size_t index = 0;
+    for(;;)
+    {
+        Token  tok    = tokenize(&speculation->lexer);
+        Lexeme lexeme = currentLexeme(&speculation->lexer);
+        if(!pushToken(&speculation->tokens, &lexeme))
+        {
+            lexError(&speculation->lexer, "Out of memory for tokens");
+            tok = TKInvalid;
+        }
+
+        if(tok == TKEnd || tok == TKInvalid)
+            break;
+
+        // From a token both states lex alike, the rest is the same as from the open state
+        if(inComment)
+        {
+            while(index < other->tokens.count && other->tokens.offsets[index] < lexeme.offset)
+                index++;
+            if(index < other->tokens.count && other->tokens.offsets[index] == lexeme.offset)
+            {
+                speculation->resume     = index + 1;
+                speculation->diagnostic = other->diagnostic;
+                break;
+            }
+        }
+    }
+
+    speculation->endsInComment = speculation->resume != SIZE_MAX ? other->endsInComment
+                                                                 : speculation->lexer.context.isBlockComment;
+}
+
+void lexChunks(void* context)
+{
+    ParallelLexer* parallel = context;
+    for(size_t i; (i = atomic_fetch_add(&parallel->next, 1)) < parallel->count;)
+    {
+        // The open state needs the other one to see where they agree
+        lexSpeculation(parallel, &parallel->chunks[i], false);
+        if(i > 0)
+            lexSpeculation(parallel, &parallel->chunks[i], true);
+    }
+}
+
+SymbolId mapSymbol(Lexer* lexer, Speculation* speculation, SymbolId symbol)
+{
+    if(speculation->symbolMap[symbol] == SYMBOL_NONE)
+    {
+        unsigned    length;
+        const char* text               = symbolText(&speculation->symbols, symbol, &length);
+        speculation->symbolMap[symbol] = intern(lexer->interner, text, length);
+    }
+    return speculation->symbolMap[symbol];
+}
+
+// Symbols of the tokens get the ids tokenizeAll would give them, strings move into the shared arena
+bool shareSpeculation(Lexer* lexer, Speculation* speculation, size_t from, size_t count)
+{
+    speculation->symbolMap = calloc(speculation->symbols.count, sizeof(SymbolId));
+    if(speculation->symbolMap == NULL)
+        return false;
+
+    // Only the strings of the tokens in use are moved, aligned as the lexer aligns them,
+    // so they get the offsets tokenizeAll would give them
+    const TokenStream* tokens  = &speculation->tokens;
+    Arena*             strings = &speculation->lexer.strings;
+    size_t             first   = strings->size;
+    for(size_t i = from; i < from + count && first == strings->size; ++i)
+    {
+        if(tokens->kinds[i] == TKStringConstant && (tokens->flags[i] & TKFlagEscaped))
+            first = (size_t)tokens->values[i];
+    }
+
+    speculation->stringFirst = first;
+    if(first < strings->size)
+    {
+        speculation->stringBase = allocateArena(&lexer->strings, strings->size - first, sizeof(uint32_t));
+        if(speculation->stringBase == ARENA_FAILED)
+            return false;
+        memcpy(arenaAt(&lexer->strings, speculation->stringBase), strings->data + first, strings->size - first);
+    }
+
+    // Local ids are in order of first use, unless the tokens start in the middle
+    if(from == 0)
+    {
+        for(SymbolId symbol = 1; symbol < speculation->symbols.count; ++symbol)
+        {
+            if(mapSymbol(lexer, speculation, symbol) == SYMBOL_NONE)
+                return false;
+        }
+        return true;
+    }
+
+    for(size_t i = from; i < from + count; ++i)
+    {
+        if(tokens->kinds[i] == TKIdentifier && mapSymbol(lexer, speculation, (SymbolId)tokens->values[i]) == SYMBOL_NONE)
+            return false;
+    }
+    return true;
+}
+
+// Picks the speculation of each chunk and places its tokens, 'last' is the last chunk in use
+bool joinChunks(ParallelLexer* parallel, size_t* total, size_t* last, bool* failed)
+{
+    bool     inComment = false;
+    unsigned flags     = 0;
+
+    *total  = 0;
+    *failed = false;
+
+    for(size_t i = 0; i < parallel->count; ++i)
+    {
+        Chunk*       chunk = &parallel->chunks[i];
+        Speculation* head  = &chunk->speculations[inComment];
+        Speculation* tail  = head->resume != SIZE_MAX ? &chunk->speculations[false] : NULL;
+
+        chunk->head      = head;
+        chunk->headCount = head->tokens.count;
+        chunk->tail      = tail;
+        chunk->tailCount = tail != NULL ? tail->tokens.count - head->resume : 0;
+
+        // The end of a chunk is trivia in front of the next one
+        const TokenStream* tokens = tail != NULL ? &tail->tokens : &head->tokens;
+        Token              end    = (Token)tokens->kinds[tokens->count - 1];
+        bool               final  = i + 1 == parallel->count || end == TKInvalid;
+        if(end == TKEnd && !final)
+        {
+            if(tail != NULL)
+                chunk->tailCount--;
+            else
+                chunk->headCount--;
+        }
+
+        chunk->first = *total;
+        chunk->flags = flags;
+        *total += chunk->headCount + chunk->tailCount;
+
+        *last = i;
+        if(!shareSpeculation(parallel->lexer, head, 0, chunk->headCount) ||
+           (tail != NULL && !shareSpeculation(parallel->lexer, tail, head->resume, chunk->tailCount)))
+            return false;
+
+        if(end == TKInvalid)
+        {
+            *failed = true;
+            return true;
+        }
+
+        flags     = (chunk->headCount + chunk->tailCount == 0 ? flags : 0) | tokens->flags[tokens->count - 1];
+        inComment = head->endsInComment;
+    }
+
+    return true;
+}
+
+void copyTokens(TokenStream* stream, size_t at, Speculation* speculation, size_t from, size_t count)
+{
+    const TokenStream* tokens = &speculation->tokens;
+    for(size_t i = 0; i < count; ++i)
+    {
+        uint8_t  kind  = tokens->kinds[from + i];
+        uint8_t  flags = tokens->flags[from + i];
+        uint64_t value = tokens->values[from + i];
+
+        if(kind == TKIdentifier)
+            value = speculation->symbolMap[value];
+        else if(kind == TKStringConstant && (flags & TKFlagEscaped))
+            value = value - speculation->stringFirst + speculation->stringBase;
+
+        stream->kinds[at + i]   = kind;
+        stream->flags[at + i]   = flags;
+        stream->values[at + i]  = value;
+        stream->offsets[at + i] = tokens->offsets[from + i];
+        stream->lengths[at + i] = tokens->lengths[from + i];
+    }
+}
+
+void copyChunks(void* context)
+{
+    ParallelLexer* parallel = context;
+    for(size_t i; (i = atomic_fetch_add(&parallel->next, 1)) < parallel->count;)
+    {
+        Chunk* chunk = &parallel->chunks[i];
+        copyTokens(parallel->stream, chunk->first, chunk->head, 0, chunk->headCount);
+        if(chunk->tail != NULL)
+            copyTokens(parallel->stream, chunk->first + chunk->headCount, chunk->tail, chunk->head->resume, chunk->tailCount);
+
+        if(chunk->headCount + chunk->tailCount > 0)
+            parallel->stream->flags[chunk->first] |= (uint8_t)chunk->flags;
+    }
+}
+
+// Runs 'work' on 'threads' threads, the calling one included
+void runWorkers(ParallelLexer* parallel, ThreadMain work, Thread* workers, unsigned threads)
+{
+    unsigned started = 0;
+
+    atomic_store(&parallel->next, 0);
+    while(started + 1 < threads && startThread(&workers[started], work, parallel))
+        started++;
+
+    work(parallel);
+    for(unsigned i = 0; i < started; ++i)
+        joinThread(&workers[i]);
+}
+
+/*
+ * Parallel lexing
+ */
+
+bool tokenizeParallel(Lexer* lexer, TokenStream* stream, unsigned threads)
+{
+    const char* source = lexer->input.data;
+    size_t      size   = lexer->input.size;
+
+    size_t count = (size_t)threads * PARALLEL_CHUNKS_PER_THREAD;
+    if(count > size / PARALLEL_MIN_CHUNK)
+        count = size / PARALLEL_MIN_CHUNK;
+    if(threads < 2 || count < 2 || lexer->input.mode != InputMapped || size > UINT32_MAX)
+        return tokenizeAll(lexer, stream);
+
+    ParallelLexer parallel;
+    parallel.lexer  = lexer;
+    parallel.stream = stream;
+    parallel.chunks = calloc(count, sizeof(Chunk));
+    parallel.count  = 0;
+
+    Thread* workers = malloc(threads * sizeof(Thread));
+    if(parallel.chunks == NULL || workers == NULL)
+    {
+        free(parallel.chunks);
+        free(workers);
+        return tokenizeAll(lexer, stream);
+    }
+
+    // Chunks begin after a line break
+    size_t begin = 0;
+    for(size_t i = 1; i <= count && begin < size; ++i)
+    {
+        size_t split = i < count ? size / count * i : size;
+        if(split < begin)
+            continue;
+
+        const char* newline = split < size ? memchr(source + split, SYMNewline, size - split) : NULL;
+        size_t      end     = newline != NULL ? (size_t)(newline - source) + 1 : size;
+
+        parallel.chunks[parallel.count].begin = begin;
+        parallel.chunks[parallel.count].end   = end;
+        parallel.count++;
+        begin = end;
+    }
+
+    runWorkers(&parallel, lexChunks, workers, threads);
+
+    size_t total;
+    size_t last;
+    bool   failed;
+    bool   joined = joinChunks(&parallel, &total, &last, &failed);
+
+    if(joined)
+    {
+        initializeTokenStream(stream, source, total);
+        if(stream->capacity < total)
+        {
+            finalizeTokenStream(stream);
+            joined = false;
+        }
+    }
+
+    if(joined)
+    {
+        parallel.count = last + 1;
+        runWorkers(&parallel, copyChunks, workers, threads);
+        stream->count = total;
+
+        // Errors are printed once the speculation they belong to is known
+        Chunk*       chunk       = &parallel.chunks[last];
+        Speculation* speculation = chunk->tail != NULL ? chunk->tail : chunk->head;
+        if(failed && speculation->diagnostic.set)
+            reportDiagnostic(lexer, &speculation->diagnostic);
+    }
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        for(int state = 0; state < 2; ++state)
+        {
+            Speculation* speculation = &parallel.chunks[i].speculations[state];
+            if(!speculation->used)
+                continue;
+
+            finalizeTokenStream(&speculation->tokens);
+            finalizeLexer(&speculation->lexer);
+            finalizeInterner(&speculation->symbols);
+            free(speculation->symbolMap);
+        }
+    }
+    free(parallel.chunks);
+    free(workers);
+
+    // Out of memory, lexing again needs less
+    if(!joined)
+        return tokenizeAll(lexer, stream);
+    return !failed;
+}
@@ -0,0 +1,24 @@
+#ifndef HEADER_PARALLEL
+#define HEADER_PARALLEL
+
+#include "lexer.h"
+#include <stdbool.h>
+
+/*
+ * Parallel lexing
+ */
+
+// Smallest chunk worth a lexer of its own
+#define PARALLEL_MIN_CHUNK (1 << 20)
+
+// Chunks per thread, threads done early take the remaining ones
+#define PARALLEL_CHUNKS_PER_THREAD 4
+
+// Like tokenizeAll, but lexes chunks of the mapped input on 'threads' threads.
+// Chunks start after a line break, where the only state left is whether a block
+// comment is open. Each chunk is lexed for both states and the joined stream
+// takes the one the previous chunk ends in. Symbols, string constants and
+// errors come out the same as with tokenizeAll.
+bool tokenizeParallel(Lexer* lexer, TokenStream* stream, unsigned threads);
+
+#endif  // HEADER_PARALLEL
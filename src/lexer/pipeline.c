@@ -0,0 +1,107 @@
+#include "pipeline.h"
+#include <stdlib.h>
+
+/*
+ * Private helpers
+ */
+
+// Fills batches until the end of input, waits while all of them are in flight
+void runLexer(void* context)
+{
+    Pipeline* pipeline = context;
+    size_t    written  = 0;
+
+    for(;;)
+    {
+        while(written - atomic_load_explicit(&pipeline->read, memory_order_acquire) == PIPELINE_BATCHES)
+        {
+            if(atomic_load_explicit(&pipeline->stopped, memory_order_relaxed))
+                return;
+            yieldThread();
+        }
+
+        TokenBatch* batch = &pipeline->batches[written % PIPELINE_BATCHES];
+        bool        end   = false;
+        for(batch->count = 0; batch->count < PIPELINE_BATCH_SIZE && !end; batch->count++)
+        {
+            Token tok = tokenize(pipeline->lexer);
+            end       = tok == TKEnd || tok == TKInvalid;
+
+            batch->tokens[batch->count] = currentLexeme(pipeline->lexer);
+        }
+
+        // Release makes the tokens visible before the batch
+        atomic_store_explicit(&pipeline->written, ++written, memory_order_release);
+        if(end)
+            return;
+    }
+}
+
+/*
+ * Pipeline
+ */
+
+bool initializePipeline(Pipeline* pipeline, Lexer* lexer)
+{
+    if(lexer->input.mode != InputMapped)
+        return false;
+
+    pipeline->batches = malloc(PIPELINE_BATCHES * sizeof(TokenBatch));
+    if(pipeline->batches == NULL)
+        return false;
+
+    pipeline->lexer    = lexer;
+    pipeline->index    = 0;
+    pipeline->finished = false;
+    atomic_init(&pipeline->written, 0);
+    atomic_init(&pipeline->read, 0);
+    atomic_init(&pipeline->stopped, false);
+
+    if(!startThread(&pipeline->thread, runLexer, pipeline))
+    {
+        free(pipeline->batches);
+        pipeline->batches = NULL;
+        return false;
+    }
+    return true;
+}
+
+void finalizePipeline(Pipeline* pipeline)
+{
+    if(pipeline->batches == NULL)
+        return;
+
+    atomic_store_explicit(&pipeline->stopped, true, memory_order_relaxed);
+    joinThread(&pipeline->thread);
+
+    free(pipeline->batches);
+    pipeline->batches = NULL;
+}
+
+void pipelineSource(void* context, Lexeme* lexeme)
+{
+    Pipeline* pipeline = context;
+    if(pipeline->finished)
+    {
+        *lexeme = pipeline->last;
+        return;
+    }
+
+    size_t read = atomic_load_explicit(&pipeline->read, memory_order_relaxed);
+    while(atomic_load_explicit(&pipeline->written, memory_order_acquire) == read)
+        yieldThread();
+
+    TokenBatch* batch = &pipeline->batches[read % PIPELINE_BATCHES];
+    *lexeme           = batch->tokens[pipeline->index++];
+
+    pipeline->finished = lexeme->tok == TKEnd || lexeme->tok == TKInvalid;
+    if(pipeline->finished)
+        pipeline->last = *lexeme;
+
+    // Hand the batch back to the lexer once it is used up
+    if(pipeline->index == batch->count || pipeline->finished)
+    {
+        pipeline->index = 0;
+        atomic_store_explicit(&pipeline->read, read + 1, memory_order_release);
+    }
+}
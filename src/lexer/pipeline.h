@@ -0,0 +1,52 @@
+#ifndef HEADER_PIPELINE
+#define HEADER_PIPELINE
+
+#include "lexer.h"
+#include "../util/thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Pipelined lexing
+ */
+
+// Tokens handed over at once, and batches in flight before the lexer waits
+#define PIPELINE_BATCH_SIZE 1024
+#define PIPELINE_BATCHES    16
+
+typedef struct TokenBatch
+{
+    Lexeme tokens[PIPELINE_BATCH_SIZE];
+    size_t count;
+} TokenBatch;
+
+// Lexer thread feeding the parser thread through a single producer, single consumer ring.
+// Only mapped input can be pipelined, token text of streamed input does not outlive the window.
+typedef struct Pipeline
+{
+    TokenBatch* batches;
+    Lexer*      lexer;
+    Thread      thread;
+
+    // Written by the lexer thread, on its own cache line
+    _Alignas(64) atomic_size_t written;  // Batches published
+
+    // Written by the parser thread
+    _Alignas(64) atomic_size_t read;  // Batches released
+    atomic_bool stopped;              // Parser needs no more tokens
+    size_t      index;                // Next token of the oldest batch
+    Lexeme      last;                 // Repeated after the end
+    bool        finished;
+} Pipeline;
+
+// Starts tokenizing 'lexer' on its own thread, which owns it until the pipeline is finalized
+bool initializePipeline(Pipeline* pipeline, Lexer* lexer);
+
+// Stops and joins the lexer thread
+void finalizePipeline(Pipeline* pipeline);
+
+// TokenSource of the parser thread, 'context' is a Pipeline
+void pipelineSource(void* context, Lexeme* lexeme);
+
+#endif  // HEADER_PIPELINE
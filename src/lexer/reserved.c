@@ -0,0 +1,88 @@
+#include "reserved.h"
+#include "keywords.h"
+#include "types.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Perfect hash
+ *
+ * Generated by tools/reserved.c: the multiplier was searched so that the key built from the first,
+ * middle and last character and the length puts every reserved word into its own slot. Add a new
+ * reserved word to the list of the tool and run 'make reserved' to search a new multiplier.
+ */
+
+#define RESERVED_HASH_MULTIPLIER 0x4dc1c507u
+#define RESERVED_HASH_BITS 6
+
+typedef struct ReservedWord
+{
+    const char*   word;
+    unsigned char length;
+    unsigned char tok;
+    unsigned char id;
+} ReservedWord;
+
+static const ReservedWord reservedWords[1 << RESERVED_HASH_BITS] = {
+    [3] = {"nil", 3, TKNilConstant, 0},
+    [4] = {"as", 2, TKKeyword, KWAs},
+    [7] = {"end", 3, TKKeyword, KWEnd},
+    [9] = {"F", 1, TKType, TYF},
+    [13] = {"S64", 3, TKType, TYS64},
+    [15] = {"ret", 3, TKKeyword, KWRet},
+    [16] = {"F64", 3, TKType, TYF64},
+    [19] = {"mod", 3, TKKeyword, KWMod},
+    [21] = {"Bool", 4, TKType, TYBool},
+    [22] = {"U8", 2, TKType, TYU8},
+    [23] = {"fun", 3, TKKeyword, KWFun},
+    [24] = {"S32", 3, TKType, TYS32},
+    [25] = {"Char", 4, TKType, TYChar},
+    [28] = {"F32", 3, TKType, TYF32},
+    [31] = {"U16", 3, TKType, TYU16},
+    [32] = {"is", 2, TKKeyword, KWIs},
+    [34] = {"while", 5, TKKeyword, KWWhile},
+    [35] = {"asm", 3, TKAsm, 0},
+    [36] = {"use", 3, TKKeyword, KWUse},
+    [41] = {"if", 2, TKKeyword, KWIf},
+    [43] = {"false", 5, TKBooleanConstant, 0},
+    [44] = {"nop", 3, TKNop, 0},
+    [46] = {"not", 3, TKKeyword, KWNot},
+    [47] = {"else", 4, TKKeyword, KWElse},
+    [48] = {"S8", 2, TKType, TYS8},
+    [49] = {"for", 3, TKKeyword, KWFor},
+    [50] = {"or", 2, TKKeyword, KWOr},
+    [51] = {"elif", 4, TKKeyword, KWElif},
+    [52] = {"U64", 3, TKType, TYU64},
+    [53] = {"true", 4, TKBooleanConstant, 1},
+    [55] = {"in", 2, TKKeyword, KWIn},
+    [56] = {"S16", 3, TKType, TYS16},
+    [57] = {"and", 3, TKKeyword, KWAnd},
+    [58] = {"dat", 3, TKKeyword, KWDat},
+    [63] = {"U32", 3, TKType, TYU32},
+};
+
+unsigned reservedHash(const char* text, size_t length)
+{
+    uint32_t key = (uint32_t)(unsigned char)text[0] | (uint32_t)(unsigned char)text[length - 1] << 8 |
+                   (uint32_t)(unsigned char)text[length / 2] << 16 | (uint32_t)length << 24;
+    return (key * RESERVED_HASH_MULTIPLIER) >> (32 - RESERVED_HASH_BITS);
+}
+
+/*
+ * Reserved words
+ */
+
+Token classifyWord(const char* text, size_t length, unsigned* id)
+{
+    *id = 0;
+
+    if(length == 0 || length > MAX_RESERVED_LENGTH)
+        return TKIdentifier;
+
+    const ReservedWord* reserved = &reservedWords[reservedHash(text, length)];
+    if(reserved->length != length || memcmp(reserved->word, text, length) != 0)
+        return TKIdentifier;
+
+    *id = reserved->id;
+    return (Token)reserved->tok;
+}
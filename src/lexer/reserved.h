@@ -0,0 +1,17 @@
+#ifndef HEADER_RESERVED
+#define HEADER_RESERVED
+
+#include "tokens.h"
+#include <stddef.h>
+
+/*
+ * Reserved words
+ */
+
+#define MAX_RESERVED_LENGTH 5
+
+// Classifies keywords, types, boolean and nil constants, nop and asm in a single lookup.
+// 'id' receives the Keyword or Type id (1 for true), anything else is an identifier.
+Token classifyWord(const char* text, size_t length, unsigned* id);
+
+#endif  // HEADER_RESERVED
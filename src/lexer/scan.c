@@ -0,0 +1,214 @@
+#include "scan.h"
+#include "symbols.h"
+#include <stdbool.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(SCAN_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define SCAN_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ * Scalar implementation, also handles the tails of the vector loops
+ */
+
+#define IN_RANGE(c, lo, hi) ((unsigned char)((c) - (lo)) <= (unsigned char)((hi) - (lo)))
+
+#define IS_IDENTIFIER(c) (IN_RANGE((c) | 0x20, SYMSmallA, SYMSmallZ) || IN_RANGE(c, SYMZero, SYMNine))
+#define IS_DIGIT(c) IN_RANGE(c, SYMZero, SYMNine)
+#define IS_HEX_DIGIT(c) (IN_RANGE(c, SYMZero, SYMNine) || IN_RANGE(c, SYMBigA, SYMBigF))
+#define IS_BINARY_DIGIT(c) ((c) == SYMZero || (c) == SYMOne)
+#define IS_SPACE(c) ((c) == SYMSpace || (c) == SYMCarriageReturn)
+#define IS_STRING(c) ((c) != SYMDoubleQuote && (c) != SYMBackslash && (c) != SYMNewline)
+#define IS_CHARACTER(c) ((c) != SYMSingleQuote && (c) != SYMBackslash && (c) != SYMNewline)
+
+#define DEFINE_SCALAR_SCANNER(name, MATCH)                  \
+    const char* name##Scalar(const char* p, const char* end) \
+    {                                                        \
+        while(p < end && MATCH((unsigned char)*p))           \
+            p++;                                             \
+        return p;                                            \
+    }
+
+DEFINE_SCALAR_SCANNER(identifier, IS_IDENTIFIER)
+DEFINE_SCALAR_SCANNER(digits, IS_DIGIT)
+DEFINE_SCALAR_SCANNER(hexDigits, IS_HEX_DIGIT)
+DEFINE_SCALAR_SCANNER(binaryDigits, IS_BINARY_DIGIT)
+DEFINE_SCALAR_SCANNER(spaces, IS_SPACE)
+DEFINE_SCALAR_SCANNER(string, IS_STRING)
+DEFINE_SCALAR_SCANNER(character, IS_CHARACTER)
+
+#ifndef SCAN_SSE2
+static const Scanners scalarScanners = {
+    "scalar",
+    identifierScalar,
+    digitsScalar,
+    hexDigitsScalar,
+    binaryDigitsScalar,
+    spacesScalar,
+    stringScalar,
+    characterScalar,
+};
+#endif
+
+unsigned countTrailingZeros(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/*
+ * SSE2, 16 bytes per step
+ */
+
+#ifdef SCAN_SSE2
+
+// Signed compare after shifting [lo, hi] to the bottom of the signed range
+#define SSE2_RANGE(v, lo, hi)                                          \
+    _mm_cmplt_epi8(                                                    \
+        _mm_add_epi8(v, _mm_set1_epi8((char)(128 - (lo)))),           \
+        _mm_set1_epi8((char)(-128 + (hi) - (lo) + 1)))
+#define SSE2_EQUAL(v, c) _mm_cmpeq_epi8(v, _mm_set1_epi8(c))
+
+#define SSE2_IDENTIFIER(v)                                                             \
+    _mm_or_si128(                                                                      \
+        SSE2_RANGE(_mm_or_si128(v, _mm_set1_epi8(0x20)), SYMSmallA, SYMSmallZ),        \
+        SSE2_RANGE(v, SYMZero, SYMNine))
+#define SSE2_DIGIT(v) SSE2_RANGE(v, SYMZero, SYMNine)
+#define SSE2_HEX_DIGIT(v) _mm_or_si128(SSE2_RANGE(v, SYMZero, SYMNine), SSE2_RANGE(v, SYMBigA, SYMBigF))
+#define SSE2_BINARY_DIGIT(v) _mm_or_si128(SSE2_EQUAL(v, SYMZero), SSE2_EQUAL(v, SYMOne))
+#define SSE2_SPACE(v) _mm_or_si128(SSE2_EQUAL(v, SYMSpace), SSE2_EQUAL(v, SYMCarriageReturn))
+#define SSE2_NONE_OF(v, a, b, c)                                                         \
+    _mm_andnot_si128(                                                                     \
+        _mm_or_si128(_mm_or_si128(SSE2_EQUAL(v, a), SSE2_EQUAL(v, b)), SSE2_EQUAL(v, c)), \
+        _mm_set1_epi8(-1))
+#define SSE2_STRING(v) SSE2_NONE_OF(v, SYMDoubleQuote, SYMBackslash, SYMNewline)
+#define SSE2_CHARACTER(v) SSE2_NONE_OF(v, SYMSingleQuote, SYMBackslash, SYMNewline)
+
+#define DEFINE_SSE2_SCANNER(name, MATCH)                                      \
+    const char* name##SSE2(const char* p, const char* end)                    \
+    {                                                                         \
+        while(end - p >= 16)                                                  \
+        {                                                                     \
+            __m128i  v    = _mm_loadu_si128((const __m128i*)p);               \
+            unsigned mask = ~(unsigned)_mm_movemask_epi8(MATCH(v)) & 0xFFFFu; \
+            if(mask != 0)                                                     \
+                return p + countTrailingZeros(mask);                          \
+            p += 16;                                                          \
+        }                                                                     \
+        return name##Scalar(p, end);                                          \
+    }
+
+DEFINE_SSE2_SCANNER(identifier, SSE2_IDENTIFIER)
+DEFINE_SSE2_SCANNER(digits, SSE2_DIGIT)
+DEFINE_SSE2_SCANNER(hexDigits, SSE2_HEX_DIGIT)
+DEFINE_SSE2_SCANNER(binaryDigits, SSE2_BINARY_DIGIT)
+DEFINE_SSE2_SCANNER(spaces, SSE2_SPACE)
+DEFINE_SSE2_SCANNER(string, SSE2_STRING)
+DEFINE_SSE2_SCANNER(character, SSE2_CHARACTER)
+
+static const Scanners sse2Scanners = {
+    "sse2",
+    identifierSSE2,
+    digitsSSE2,
+    hexDigitsSSE2,
+    binaryDigitsSSE2,
+    spacesSSE2,
+    stringSSE2,
+    characterSSE2,
+};
+
+#endif
+
+/*
+ * AVX2, 32 bytes per step
+ */
+
+#ifdef SCAN_AVX2
+
+#define AVX2_RANGE(v, lo, hi)                                      \
+    _mm256_cmpgt_epi8(                                             \
+        _mm256_set1_epi8((char)(-128 + (hi) - (lo) + 1)),          \
+        _mm256_add_epi8(v, _mm256_set1_epi8((char)(128 - (lo)))))
+#define AVX2_EQUAL(v, c) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))
+
+#define AVX2_IDENTIFIER(v)                                                                \
+    _mm256_or_si256(                                                                      \
+        AVX2_RANGE(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), SYMSmallA, SYMSmallZ),     \
+        AVX2_RANGE(v, SYMZero, SYMNine))
+#define AVX2_DIGIT(v) AVX2_RANGE(v, SYMZero, SYMNine)
+#define AVX2_HEX_DIGIT(v) \
+    _mm256_or_si256(AVX2_RANGE(v, SYMZero, SYMNine), AVX2_RANGE(v, SYMBigA, SYMBigF))
+#define AVX2_BINARY_DIGIT(v) _mm256_or_si256(AVX2_EQUAL(v, SYMZero), AVX2_EQUAL(v, SYMOne))
+#define AVX2_SPACE(v) _mm256_or_si256(AVX2_EQUAL(v, SYMSpace), AVX2_EQUAL(v, SYMCarriageReturn))
+#define AVX2_NONE_OF(v, a, b, c)                                                               \
+    _mm256_andnot_si256(                                                                        \
+        _mm256_or_si256(_mm256_or_si256(AVX2_EQUAL(v, a), AVX2_EQUAL(v, b)), AVX2_EQUAL(v, c)), \
+        _mm256_set1_epi8(-1))
+#define AVX2_STRING(v) AVX2_NONE_OF(v, SYMDoubleQuote, SYMBackslash, SYMNewline)
+#define AVX2_CHARACTER(v) AVX2_NONE_OF(v, SYMSingleQuote, SYMBackslash, SYMNewline)
+
+#define DEFINE_AVX2_SCANNER(name, MATCH)                                           \
+    __attribute__((target("avx2"))) const char* name##AVX2(const char* p, const char* end) \
+    {                                                                              \
+        while(end - p >= 32)                                                       \
+        {                                                                          \
+            __m256i  v    = _mm256_loadu_si256((const __m256i*)p);                 \
+            unsigned mask = ~(unsigned)_mm256_movemask_epi8(MATCH(v));             \
+            if(mask != 0)                                                          \
+                return p + countTrailingZeros(mask);                               \
+            p += 32;                                                               \
+        }                                                                          \
+        return name##SSE2(p, end);                                                 \
+    }
+
+DEFINE_AVX2_SCANNER(identifier, AVX2_IDENTIFIER)
+DEFINE_AVX2_SCANNER(digits, AVX2_DIGIT)
+DEFINE_AVX2_SCANNER(hexDigits, AVX2_HEX_DIGIT)
+DEFINE_AVX2_SCANNER(binaryDigits, AVX2_BINARY_DIGIT)
+DEFINE_AVX2_SCANNER(spaces, AVX2_SPACE)
+DEFINE_AVX2_SCANNER(string, AVX2_STRING)
+DEFINE_AVX2_SCANNER(character, AVX2_CHARACTER)
+
+static const Scanners avx2Scanners = {
+    "avx2",
+    identifierAVX2,
+    digitsAVX2,
+    hexDigitsAVX2,
+    binaryDigitsAVX2,
+    spacesAVX2,
+    stringAVX2,
+    characterAVX2,
+};
+
+#endif
+
+/*
+ * Selection
+ */
+
+const Scanners* selectScanners(void)
+{
+#ifdef SCAN_AVX2
+    if(__builtin_cpu_supports("avx2"))
+        return &avx2Scanners;
+#endif
+#ifdef SCAN_SSE2
+    return &sse2Scanners;
+#else
+    return &scalarScanners;
+#endif
+}
@@ -0,0 +1,26 @@
+#ifndef HEADER_SCAN
+#define HEADER_SCAN
+
+/*
+ * Run scanners
+ */
+
+// Returns the first position in [p, end) that does not continue the run
+typedef const char* (*ScanFunction)(const char* p, const char* end);
+
+typedef struct Scanners
+{
+    const char*  name;
+    ScanFunction identifier;    // [A-Za-z0-9]
+    ScanFunction digits;        // [0-9]
+    ScanFunction hexDigits;     // [0-9A-F]
+    ScanFunction binaryDigits;  // [01]
+    ScanFunction spaces;        // Space and carriage return
+    ScanFunction string;        // Up to '"', backslash or line break
+    ScanFunction character;     // Up to ''', backslash or line break
+} Scanners;
+
+// Picks the widest vector implementation the CPU supports
+const Scanners* selectScanners(void);
+
+#endif  // HEADER_SCAN
@@ -5,6 +5,7 @@ enum Symbol
 {
     // Control symbols
     SYMAtSign           = '@',
+    SYMBackslash        = '\\',
     SYMBracketClose     = ']',
     SYMBracketOpen      = '[',
     SYMColon            = ':',
@@ -14,6 +15,7 @@ enum Symbol
     SYMDollarSign       = '$',
     SYMDoubleQuote      = '"',
     SYMExclamationMark  = '!',
+    SYMCarriageReturn   = '\r',
     SYMNewline          = '\n',
     SYMNumberSign       = '#',
     SYMParenthesisClose = ')',
@@ -65,6 +67,9 @@ enum Symbol
     SYMSmallD = 'd',
     SYMSmallE = 'e',
     SYMSmallF = 'f',
+    SYMSmallN = 'n',
+    SYMSmallR = 'r',
+    SYMSmallT = 't',
     SYMSmallX = 'x',
     SYMSmallZ = 'z',
 
@@ -0,0 +1,58 @@
+#include "tokenring.h"
+#include "lexer.h"
+
+/*
+ * Token ring
+ */
+
+void initializeTokenRing(TokenRing* ring, TokenSource source, void* context)
+{
+    ring->head    = 0;
+    ring->count   = 0;
+    ring->source  = source;
+    ring->context = context;
+}
+
+const Lexeme* peekToken(TokenRing* ring, size_t k)
+{
+    while(ring->count <= k)
+    {
+        ring->source(ring->context, &ring->tokens[(ring->head + ring->count) & (TOKEN_RING_SIZE - 1)]);
+        ring->count++;
+    }
+
+    return &ring->tokens[(ring->head + k) & (TOKEN_RING_SIZE - 1)];
+}
+
+Lexeme consumeToken(TokenRing* ring)
+{
+    Lexeme lexeme = *peekToken(ring, 0);
+    ring->head    = (ring->head + 1) & (TOKEN_RING_SIZE - 1);
+    ring->count--;
+    return lexeme;
+}
+
+/*
+ * Sources
+ */
+
+void lexerSource(void* context, Lexeme* lexeme)
+{
+    Lexer* lexer = context;
+    tokenize(lexer);
+    *lexeme = currentLexeme(lexer);
+}
+
+void streamSource(void* context, Lexeme* lexeme)
+{
+    StreamReader* reader = context;
+    if(reader->stream->count == 0)
+    {
+        *lexeme = (Lexeme){.tok = TKEnd, .text = reader->stream->source};
+        return;
+    }
+
+    *lexeme = tokenAt(reader->stream, reader->index);
+    if(reader->index + 1 < reader->stream->count)
+        reader->index++;
+}
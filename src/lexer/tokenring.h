@@ -0,0 +1,55 @@
+#ifndef HEADER_TOKENRING
+#define HEADER_TOKENRING
+
+#include "tokens.h"
+#include "tokenstream.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Token ring
+ */
+
+// Tokens the parser can look ahead, a power of two
+#define TOKEN_RING_SIZE 8
+
+// Writes the next token, sources keep returning their last token at the end
+typedef void (*TokenSource)(void* context, Lexeme* lexeme);
+
+// Tokens taken from a source but not consumed yet, the input is never read twice
+typedef struct TokenRing
+{
+    Lexeme      tokens[TOKEN_RING_SIZE];
+    size_t      head;   // Index of the next token to consume
+    size_t      count;  // Tokens read ahead
+    TokenSource source;
+    void*       context;
+} TokenRing;
+
+void initializeTokenRing(TokenRing* ring, TokenSource source, void* context);
+
+// Token 'k' places ahead, 0 is the next one to consume. 'k' must be below TOKEN_RING_SIZE.
+// The text of streamed tokens read ahead may move when the lexer refills its window,
+// their offsets stay valid.
+const Lexeme* peekToken(TokenRing* ring, size_t k);
+
+Lexeme consumeToken(TokenRing* ring);
+
+/*
+ * Sources
+ */
+
+// Tokenizes on demand, 'context' is a Lexer
+void lexerSource(void* context, Lexeme* lexeme);
+
+// Tokens of a stream in order
+typedef struct StreamReader
+{
+    const TokenStream* stream;
+    size_t             index;
+} StreamReader;
+
+// 'context' is a StreamReader
+void streamSource(void* context, Lexeme* lexeme);
+
+#endif  // HEADER_TOKENRING
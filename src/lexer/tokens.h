@@ -1,6 +1,9 @@
 #ifndef HEADER_TOKENS
 #define HEADER_TOKENS
 
+#include <stddef.h>
+#include <stdint.h>
+
 typedef enum Token
 {
     TKUndefined,
@@ -24,9 +27,19 @@ typedef enum Token
     TKType,
     
     TKAssignment,
+    TKAssignmentMultiplication,
+    TKAssignmentDivision,
+    TKAssignmentAddition,
+    TKAssignmentSubtraction,
+    TKAssignmentModulo,
+    TKAssignmentAND,
+    TKAssignmentOR,
+    TKAssignmentXOR,
 
+    TKOperatorPower,
     TKOperatorMultiplication,
     TKOperatorDivision,
+    TKOperatorFloorDivision,
     TKOperatorAddition,
     TKOperatorSubtraction,
     TKOperatorModulo,
@@ -34,11 +47,14 @@ typedef enum Token
     TKOperatorOR,
     TKOperatorXOR,
     TKOperatorCOMP,
+    TKOperatorEqual,
     TKOperatorGreaterThan,
+    TKOperatorGreaterEqual,
     TKOperatorLessThan,
+    TKOperatorLessEqual,
 
-    TKStringBorder,
-    TKCharacterBorder,
+    TKStringConstant,
+    TKCharacterConstant,
 
     TKBlockBegin,
     TKBlockEnd,
@@ -53,6 +69,26 @@ typedef enum Token
 
     TKInvalid,
     TKEnd,
+    TKCount
 } Token;
 
+typedef enum TokenFlag
+{
+    TKFlagSpace   = 1 << 0,  // Preceded by whitespace
+    TKFlagNewline = 1 << 1,  // Preceded by a line break
+    TKFlagComment = 1 << 2,  // Preceded by a comment
+    TKFlagEscaped = 1 << 3,  // String with escapes, the value is the offset of the decoded text
+} TokenFlag;
+
+// A single token with its text as a span into the source
+typedef struct Lexeme
+{
+    Token       tok;
+    unsigned    flags;
+    uint64_t    value;  // Keyword, type or symbol id, constant value or float bits
+    size_t      offset;
+    unsigned    length;
+    const char* text;
+} Lexeme;
+
 #endif  // HEADER_TOKENS
\ No newline at end of file
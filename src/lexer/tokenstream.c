@@ -0,0 +1,94 @@
+#include "tokenstream.h"
+#include <stdlib.h>
+
+/*
+ * Private helpers
+ */
+
+bool reserveTokens(TokenStream* stream, size_t capacity)
+{
+    uint8_t*  kinds   = realloc(stream->kinds, capacity * sizeof(uint8_t));
+    uint8_t*  flags   = realloc(stream->flags, capacity * sizeof(uint8_t));
+    uint64_t* values  = realloc(stream->values, capacity * sizeof(uint64_t));
+    uint32_t* offsets = realloc(stream->offsets, capacity * sizeof(uint32_t));
+    uint32_t* lengths = realloc(stream->lengths, capacity * sizeof(uint32_t));
+
+    // Keep whatever was reallocated so finalizing frees it
+    if(kinds != NULL)
+        stream->kinds = kinds;
+    if(flags != NULL)
+        stream->flags = flags;
+    if(values != NULL)
+        stream->values = values;
+    if(offsets != NULL)
+        stream->offsets = offsets;
+    if(lengths != NULL)
+        stream->lengths = lengths;
+
+    if(kinds == NULL || flags == NULL || values == NULL || offsets == NULL || lengths == NULL)
+        return false;
+
+    stream->capacity = capacity;
+    return true;
+}
+
+/*
+ * Token stream
+ */
+
+void initializeTokenStream(TokenStream* stream, const char* source, size_t expected)
+{
+    stream->kinds    = NULL;
+    stream->flags    = NULL;
+    stream->values   = NULL;
+    stream->offsets  = NULL;
+    stream->lengths  = NULL;
+    stream->count    = 0;
+    stream->capacity = 0;
+    stream->source   = source;
+
+    reserveTokens(stream, expected > 16 ? expected : 16);
+}
+
+void finalizeTokenStream(TokenStream* stream)
+{
+    free(stream->kinds);
+    free(stream->flags);
+    free(stream->values);
+    free(stream->offsets);
+    free(stream->lengths);
+
+    stream->kinds    = NULL;
+    stream->flags    = NULL;
+    stream->values   = NULL;
+    stream->offsets  = NULL;
+    stream->lengths  = NULL;
+    stream->count    = 0;
+    stream->capacity = 0;
+}
+
+bool pushToken(TokenStream* stream, const Lexeme* lexeme)
+{
+    if(stream->count == stream->capacity && !reserveTokens(stream, stream->capacity * 2))
+        return false;
+
+    stream->kinds[stream->count]   = (uint8_t)lexeme->tok;
+    stream->flags[stream->count]   = (uint8_t)lexeme->flags;
+    stream->values[stream->count]  = lexeme->value;
+    stream->offsets[stream->count] = (uint32_t)lexeme->offset;
+    stream->lengths[stream->count] = lexeme->length;
+    stream->count++;
+    return true;
+}
+
+Lexeme tokenAt(const TokenStream* stream, size_t index)
+{
+    Lexeme lexeme;
+    lexeme.tok    = (Token)stream->kinds[index];
+    lexeme.flags  = stream->flags[index];
+    lexeme.value  = stream->values[index];
+    lexeme.offset = stream->offsets[index];
+    lexeme.length = stream->lengths[index];
+    lexeme.text   = stream->source + lexeme.offset;
+    return lexeme;
+}
@@ -0,0 +1,36 @@
+#ifndef HEADER_TOKENSTREAM
+#define HEADER_TOKENSTREAM
+
+#include "tokens.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Token stream
+ */
+
+// All tokens of a source as struct of arrays, token text is a span into 'source'
+typedef struct TokenStream
+{
+    uint8_t*    kinds;
+    uint8_t*    flags;
+    uint64_t*   values;
+    uint32_t*   offsets;
+    uint32_t*   lengths;
+    size_t      count;
+    size_t      capacity;
+    const char* source;
+} TokenStream;
+
+void initializeTokenStream(TokenStream* stream, const char* source, size_t expected);
+
+void finalizeTokenStream(TokenStream* stream);
+
+// Grows the arrays to hold 'capacity' tokens
+bool reserveTokens(TokenStream* stream, size_t capacity);
+
+bool pushToken(TokenStream* stream, const Lexeme* lexeme);
+
+Lexeme tokenAt(const TokenStream* stream, size_t index);
+
+#endif  // HEADER_TOKENSTREAM
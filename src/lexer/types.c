@@ -1,11 +1,60 @@
 #include "types.h"
+#include "number.h"
+#include "reserved.h"
+#include <float.h>
 #include <string.h>
 
 bool isType(const char* word)
 {
-    return strcmp(word, BOOL) == 0 || strcmp(word, CHAR) == 0 || strcmp(word, U8) == 0 ||
-           strcmp(word, U16) == 0 || strcmp(word, U32) == 0 || strcmp(word, U64) == 0 ||
-           strcmp(word, S8) == 0 || strcmp(word, S16) == 0 || strcmp(word, S32) == 0 ||
-           strcmp(word, S64) == 0 || strcmp(word, F32) == 0 || strcmp(word, F64) == 0 ||
-           strcmp(word, F) == 0;
+    unsigned id;
+    return classifyWord(word, strlen(word), &id) == TKType;
+}
+
+bool fitsType(Type type, Token tok, uint64_t value)
+{
+    if(tok == TKNilConstant)
+        return true;
+    if(tok == TKBooleanConstant)
+        return type == TYBool;
+    if(tok == TKCharacterConstant)
+        return type == TYChar;
+    if(tok == TKStringConstant)
+        return false;  // No string type yet
+
+    if(tok == TKFloatConstant)
+    {
+        // Float constants are never negative either, too large ones are infinity
+        double number = bitsToFloat(value);
+        if(type == TYF32)
+            return number <= FLT_MAX;
+        return (type == TYF64 || type == TYF) && number <= DBL_MAX;
+    }
+
+    // Integer constants are never negative, float types take any of them
+    switch(type)
+    {
+        case TYChar:
+        case TYU8:
+            return value <= UINT8_MAX;
+        case TYU16:
+            return value <= UINT16_MAX;
+        case TYU32:
+            return value <= UINT32_MAX;
+        case TYU64:
+            return true;
+        case TYS8:
+            return value <= INT8_MAX;
+        case TYS16:
+            return value <= INT16_MAX;
+        case TYS32:
+            return value <= INT32_MAX;
+        case TYS64:
+            return value <= INT64_MAX;
+        case TYF32:
+        case TYF64:
+        case TYF:
+            return true;
+        default:
+            return false;
+    }
 }
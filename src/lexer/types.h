@@ -1,7 +1,9 @@
 #ifndef HEADER_TYPES
 #define HEADER_TYPES
 
+#include "tokens.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 static const char* BOOL = "Bool";
 static const char* CHAR = "Char";
@@ -17,6 +19,27 @@ static const char* F32  = "F32";
 static const char* F64  = "F64";
 static const char* F    = "F";
 
+typedef enum Type
+{
+    TYNone,
+    TYBool,
+    TYChar,
+    TYU8,
+    TYU16,
+    TYU32,
+    TYU64,
+    TYS8,
+    TYS16,
+    TYS32,
+    TYS64,
+    TYF32,
+    TYF64,
+    TYF,
+} Type;
+
 bool isType(const char* word);
 
+// Whether a constant token with its decoded value can be assigned to 'type'
+bool fitsType(Type type, Token tok, uint64_t value);
+
 #endif  // HEADER_TYPES
\ No newline at end of file
@@ -1,25 +1,151 @@
+#include "driver/driver.h"
+#include "driver/server.h"
 #include "lexer/lexer.h"
+#include "lexer/parallel.h"
+#include "lexer/pipeline.h"
 #include "parser/parser.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-int main(int argc, char** argv)
+bool step(Parser* parser, TokenRing* tokens, Lexeme* lexeme)
+{
+    *lexeme = *peekToken(tokens, 0);
+    if(!parse(parser, tokens))
+        return false;
+
+    printf("%-20.*s -> %s\n", lexeme->length, lexeme->text, tokenToString(lexeme->tok));
+    printf("%-20c   -> %d\n", ' ', parser->state);
+    return true;
+}
+
+// Prints each token and parser state of a single file, then its tree
+int traceFile(const char* filename, bool pipelined, unsigned threads)
 {
+    Interner interner;
+    if(!initializeInterner(&interner))
+        return 1;
+
+    // Reads stdin when no file or "-" is given
     Lexer lexer;
-    initializeLexer(&lexer, argv[1]);
+    if(!initializeLexer(&lexer, filename, &interner))
+    {
+        printf("Could not open '%s'\n", filename);
+        return 1;
+    }
+
+    Ast ast;
+    if(!initializeAst(&ast))
+        return 1;
 
     Parser parser;
-    initializeParser(&parser);
+    if(!initializeParser(&parser, &ast))
+        return 1;
+
+    Lexeme       lexeme;
+    TokenRing    tokens;
+    TokenStream  stream;
+    StreamReader reader   = {&stream, 0};
+    Pipeline     pipeline = {.batches = NULL};
+    bool         lexed    = true;
+
+    // Mapped input is tokenized up front or alongside parsing, streamed input on demand
+    if(pipelined && initializePipeline(&pipeline, &lexer))
+    {
+        initializeTokenStream(&stream, NULL, 0);
+        initializeTokenRing(&tokens, pipelineSource, &pipeline);
+    }
+    else if(lexer.input.mode == InputMapped)
+    {
+        // An empty stream could not be built, lexing errors end it with TKInvalid
+        lexed = tokenizeParallel(&lexer, &stream, threads) || stream.count > 0;
+        initializeTokenRing(&tokens, streamSource, &reader);
+    }
+    else
+    {
+        initializeTokenStream(&stream, NULL, 0);
+        initializeTokenRing(&tokens, lexerSource, &lexer);
+    }
 
-    int max = 0;
-    while(parse(&parser, tokenize(&lexer), lexer.word) && max < 5000) {
-        printf("%-20s -> %s\n", lexer.word, tokenToString(lexer.tok));
-        printf("%-20c   -> %d\n", ' ', parser.state);
-        max++;
-    };
+    while(lexed && step(&parser, &tokens, &lexeme))
+        ;
 
-    if(parser.state == ASTInvalid)
-        lexError(&lexer, "Invalid syntax");
+    // The lexer belongs to this thread again
+    finalizePipeline(&pipeline);
 
+    bool printed = true;
+    if(lexed && parser.state == ASTInvalid)
+        lexErrorAt(&lexer, &lexeme, "Invalid syntax at '%.*s'", lexeme.length, lexeme.text);
+    else if(lexed)
+        printed = printAst(&ast, &interner);
+
+    if(!printed)
+        printf("Out of memory\n");
+
+    finalizeTokenStream(&stream);
+    finalizeParser(&parser);
+    finalizeAst(&ast);
     finalizeLexer(&lexer);
-    return 0;
+    finalizeInterner(&interner);
+    return lexed && printed ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    // Lexes on its own thread with --pipeline, or on N threads up front with --lex-threads N.
+    // Several files or -j N compile the files on N workers, all processors by default,
+    // --cache DIR keeps their results in DIR for the next run, --modules DIR keeps
+    // the interfaces of named modules in DIR for 'use'. --server SOCKET keeps the workers
+    // and all they loaded between compiles, which --connect SOCKET sends it files for
+    // and --stop SOCKET ends.
+    const char** files     = malloc(argc * sizeof(const char*));
+    size_t       count     = 0;
+    bool         pipelined = false;
+    unsigned     threads   = 1;
+    unsigned     jobs      = 0;
+    const char*  cache     = NULL;
+    const char*  modules   = NULL;
+    const char*  server    = NULL;
+    const char*  connect   = NULL;
+    const char*  stop      = NULL;
+    if(files == NULL)
+        return 1;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--pipeline") == 0)
+            pipelined = true;
+        else if(strcmp(argv[i], "--lex-threads") == 0 && i + 1 < argc)
+            threads = (unsigned)atoi(argv[++i]);
+        else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            jobs = (unsigned)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            cache = argv[++i];
+        else if(strcmp(argv[i], "--modules") == 0 && i + 1 < argc)
+            modules = argv[++i];
+        else if(strcmp(argv[i], "--server") == 0 && i + 1 < argc)
+            server = argv[++i];
+        else if(strcmp(argv[i], "--connect") == 0 && i + 1 < argc)
+            connect = argv[++i];
+        else if(strcmp(argv[i], "--stop") == 0 && i + 1 < argc)
+            stop = argv[++i];
+        else
+            files[count++] = argv[i];
+    }
+
+    int    result;
+    size_t failed = 0;
+    if(server != NULL)
+        result = !serveCompiles(server, jobs > 0 ? jobs : processorCount(), cache, modules);
+    else if(connect != NULL)
+        result = !requestCompile(connect, files, count, &failed) || failed > 0;
+    else if(stop != NULL)
+        result = !requestStop(stop);
+    else if(count > 1 || jobs > 0 || cache != NULL || modules != NULL)
+        result = compileFiles(files, count, jobs > 0 ? jobs : processorCount(), cache, modules) > 0;
+    else
+        result = traceFile(count > 0 ? files[0] : NULL, pipelined, threads);
+
+    free(files);
+    return result;
 }
@@ -0,0 +1,276 @@
+#include "ast.h"
+#include "../lexer/keywords.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Private helpers
+ */
+
+const char* nodeKindToString(NodeKind kind)
+{
+    switch(kind)
+    {
+        case NDModule:
+            return "Module";
+        case NDNop:
+            return "Nop";
+        case NDAssignment:
+            return "Assignment";
+        case NDDat:
+            return "Dat";
+        case NDField:
+            return "Field";
+        case NDFun:
+            return "Fun";
+        case NDParameter:
+            return "Parameter";
+        case NDIf:
+            return "If";
+        case NDBranch:
+            return "Branch";
+        case NDElse:
+            return "Else";
+        case NDFor:
+            return "For";
+        case NDWhile:
+            return "While";
+        case NDMod:
+            return "Mod";
+        case NDReturn:
+            return "Return";
+        case NDUse:
+            return "Use";
+        case NDExpression:
+            return "Expression";
+        default:
+            return "None";
+    }
+}
+
+const char* operatorToString(const Expression* expression)
+{
+    if(expression->tok == TKKeyword)
+        return expression->value == KWAnd ? "and" : expression->value == KWOr ? "or" : expression->value == KWIs ? "is" : "not";
+
+    switch(expression->tok)
+    {
+        case TKOperatorPower:
+            return "**";
+        case TKOperatorMultiplication:
+            return "*";
+        case TKOperatorDivision:
+            return "/";
+        case TKOperatorFloorDivision:
+            return "//";
+        case TKOperatorAddition:
+            return "+";
+        case TKOperatorSubtraction:
+            return expression->kind == EXUnary ? "neg" : "-";
+        case TKOperatorModulo:
+            return "%";
+        case TKOperatorAND:
+            return "&";
+        case TKOperatorOR:
+            return "|";
+        case TKOperatorXOR:
+            return "^";
+        case TKOperatorCOMP:
+            return "~";
+        case TKOperatorEqual:
+            return "==";
+        case TKOperatorGreaterThan:
+            return ">";
+        case TKOperatorGreaterEqual:
+            return ">=";
+        case TKOperatorLessThan:
+            return "<";
+        case TKOperatorLessEqual:
+            return "<=";
+        default:
+            return "?";
+    }
+}
+
+// Postfix notation, the subtree of 'root' starts at its leftmost operand
+void printExpression(const Ast* ast, const Interner* interner, ExpressionIndex root)
+{
+    ExpressionIndex first = root;
+    while(expressionAt(ast, first)->left != 0)
+        first = expressionAt(ast, first)->left;
+
+    for(ExpressionIndex index = first; index <= root; ++index)
+    {
+        const Expression* expression = expressionAt(ast, index);
+        if(expression->kind == EXIdentifier)
+        {
+            unsigned    length;
+            const char* name = symbolText(interner, (SymbolId)expression->value, &length);
+            printf(" %.*s", length, name);
+        }
+        else if(expression->kind == EXConstant)
+            printf(" %llu", (unsigned long long)expression->value);
+        else
+            printf(" %s", operatorToString(expression));
+    }
+}
+
+void printNode(const Ast* ast, const Interner* interner, const Node* node, size_t depth)
+{
+    printf("%*s%s", (int)(2 * depth), "", nodeKindToString(node->kind));
+
+    if(node->name != SYMBOL_NONE)
+    {
+        unsigned    length;
+        const char* name = symbolText(interner, node->name, &length);
+        printf(" %.*s", length, name);
+    }
+    if(node->type != 0)
+        printf(" : %u", node->type);
+    if(node->kind == NDExpression)
+        printExpression(ast, interner, (ExpressionIndex)node->value);
+    printf("\n");
+}
+
+/*
+ * Abstract syntax tree
+ */
+
+bool initializeAst(Ast* ast)
+{
+    initializeArena(&ast->nodes, 1024 * sizeof(Node));
+    initializeArena(&ast->expressions, 1024 * sizeof(Expression));
+    return clearAst(ast);
+}
+
+void finalizeAst(Ast* ast)
+{
+    finalizeArena(&ast->nodes);
+    finalizeArena(&ast->expressions);
+    ast->root = NODE_NONE;
+}
+
+bool clearAst(Ast* ast)
+{
+    resetArena(&ast->nodes);
+    resetArena(&ast->expressions);
+
+    // Index 0 is NODE_NONE, expression 0 is none as well
+    ast->root = NODE_NONE;
+    addNode(ast, NDNone, NULL);
+    addExpression(ast, EXNone, NULL, 0, 0);
+    ast->root = addNode(ast, NDModule, NULL);
+    return ast->root != NODE_NONE;
+}
+
+NodeIndex addNode(Ast* ast, NodeKind kind, const Lexeme* lexeme)
+{
+    size_t offset = allocateArena(&ast->nodes, sizeof(Node), sizeof(uint64_t));
+    if(offset == ARENA_FAILED)
+        return NODE_NONE;
+
+    Node* node   = arenaAt(&ast->nodes, offset);
+    node->kind   = (uint8_t)kind;
+    node->tok    = lexeme != NULL ? (uint8_t)lexeme->tok : 0;
+    node->type   = 0;
+    node->flags  = lexeme != NULL ? (uint8_t)lexeme->flags : 0;
+    node->name   = SYMBOL_NONE;
+    node->first  = NODE_NONE;
+    node->next   = NODE_NONE;
+    node->offset = lexeme != NULL ? (uint32_t)lexeme->offset : 0;
+    node->length = lexeme != NULL ? lexeme->length : 0;
+    node->value  = lexeme != NULL ? lexeme->value : 0;
+    return (NodeIndex)(offset / sizeof(Node));
+}
+
+Node* nodeAt(const Ast* ast, NodeIndex index)
+{
+    return (Node*)arenaAt(&ast->nodes, (size_t)index * sizeof(Node));
+}
+
+void appendChild(Ast* ast, NodeIndex parent, NodeIndex* last, NodeIndex child)
+{
+    if(*last == NODE_NONE)
+        nodeAt(ast, parent)->first = child;
+    else
+        nodeAt(ast, *last)->next = child;
+
+    *last = child;
+}
+
+size_t nodeCount(const Ast* ast)
+{
+    return ast->nodes.size / sizeof(Node);
+}
+
+ExpressionIndex addExpression(Ast* ast, ExpressionKind kind, const Lexeme* lexeme, ExpressionIndex left, ExpressionIndex right)
+{
+    size_t offset = allocateArena(&ast->expressions, sizeof(Expression), sizeof(uint64_t));
+    if(offset == ARENA_FAILED)
+        return 0;
+
+    Expression* expression = arenaAt(&ast->expressions, offset);
+    expression->kind       = (uint8_t)kind;
+    expression->tok        = lexeme != NULL ? (uint8_t)lexeme->tok : 0;
+    expression->flags      = lexeme != NULL ? (uint8_t)lexeme->flags : 0;
+    expression->left       = left;
+    expression->right      = right;
+    expression->offset     = lexeme != NULL ? (uint32_t)lexeme->offset : 0;
+    expression->length     = lexeme != NULL ? lexeme->length : 0;
+    expression->value      = lexeme != NULL ? lexeme->value : 0;
+    return (ExpressionIndex)(offset / sizeof(Expression));
+}
+
+Expression* expressionAt(const Ast* ast, ExpressionIndex index)
+{
+    return (Expression*)arenaAt(&ast->expressions, (size_t)index * sizeof(Expression));
+}
+
+bool printAst(const Ast* ast, const Interner* interner)
+{
+    // Next node to print on each level, nesting is only limited by memory
+    size_t     capacity = AST_PRINT_STACK_SIZE;
+    size_t     depth    = 0;
+    NodeIndex* pending  = malloc(capacity * sizeof(NodeIndex));
+    if(pending == NULL)
+        return false;
+
+    pending[0] = ast->root;
+    while(true)
+    {
+        NodeIndex index = pending[depth];
+        if(index == NODE_NONE)
+        {
+            if(depth == 0)
+                break;
+
+            depth -= 1;
+            continue;
+        }
+
+        const Node* node = nodeAt(ast, index);
+        printNode(ast, interner, node, depth);
+        pending[depth] = node->next;
+        if(node->first == NODE_NONE)
+            continue;
+
+        if(depth + 1 == capacity)
+        {
+            NodeIndex* grown = realloc(pending, capacity * 2 * sizeof(NodeIndex));
+            if(grown == NULL)
+            {
+                free(pending);
+                return false;
+            }
+
+            pending = grown;
+            capacity *= 2;
+        }
+
+        depth += 1;
+        pending[depth] = node->first;
+    }
+
+    free(pending);
+    return true;
+}
@@ -1,14 +1,134 @@
 #ifndef HEADER_AST
 #define HEADER_AST
 
-typedef struct Identifier
+#include "../lexer/tokens.h"
+#include "../util/arena.h"
+#include "../util/interner.h"
+#include <stdint.h>
+
+/*
+ * Abstract syntax tree
+ */
+
+// Children are linked through 'first' and 'next', statement nodes list their
+// parts before their body statements:
+//   NDModule      statements
+//   NDAssignment  name, type, value expression, NDFun or NDMod
+//   NDDat         name, NDField...
+//   NDFun         optional name, NDParameter..., statements
+//   NDIf          NDBranch..., optional NDElse
+//   NDBranch      condition, statements
+//   NDElse        statements
+//   NDFor         name of the variable, iterated expression, statements
+//   NDWhile       condition, statements
+//   NDMod         statements
+//   NDReturn      optional expression
+//   NDUse         none, the name is the module
+//   NDExpression  none, the value is the root in the expression pool
+typedef enum NodeKind
 {
-    const char* name;
-} Identifier;
+    NDNone,
+
+    NDModule,
+    NDNop,
+    NDAssignment,
+    NDDat,
+    NDField,
+    NDFun,
+    NDParameter,
+    NDIf,
+    NDBranch,
+    NDElse,
+    NDFor,
+    NDWhile,
+    NDMod,
+    NDReturn,
+    NDUse,
+
+    NDExpression,
+} NodeKind;
 
-typedef struct AsignmentExpression
+// Index into the node arena, NODE_NONE ends child lists
+typedef uint32_t NodeIndex;
+
+#define NODE_NONE 0
+
+typedef struct Node
 {
-    Identifier Identifier;
-} AsignmentExpression;
+    uint8_t   kind;
+    uint8_t   tok;     // Token of constants
+    uint8_t   type;    // Declared type
+    uint8_t   flags;   // Token flags of constants
+    SymbolId  name;
+    NodeIndex first;
+    NodeIndex next;
+    uint32_t  offset;  // Source span of the first token
+    uint32_t  length;
+    uint64_t  value;   // Root of expressions
+} Node;
+
+/*
+ * Expressions
+ */
+
+typedef enum ExpressionKind
+{
+    EXNone,
+    EXIdentifier,
+    EXConstant,
+    EXUnary,
+    EXBinary,
+} ExpressionKind;
+
+// Index into the expression pool, operands always come before their operator
+typedef uint32_t ExpressionIndex;
+
+typedef struct Expression
+{
+    uint8_t         kind;
+    uint8_t         tok;     // Operator or constant token
+    uint8_t         flags;   // Token flags of constants
+    ExpressionIndex left;    // Operand of unary operators
+    ExpressionIndex right;
+    uint32_t        offset;
+    uint32_t        length;
+    uint64_t        value;   // Constant value, symbol id or keyword of keyword operators
+} Expression;
+
+// All nodes and expressions in two arenas, freed at once
+typedef struct Ast
+{
+    Arena     nodes;
+    Arena     expressions;  // Flat and in post-order
+    NodeIndex root;
+} Ast;
+
+bool initializeAst(Ast* ast);
+
+void finalizeAst(Ast* ast);
+
+// Empties the tree down to its module, the memory is kept
+bool clearAst(Ast* ast);
+
+// Returns NODE_NONE if out of memory, pointers to nodes are invalidated by adding nodes
+NodeIndex addNode(Ast* ast, NodeKind kind, const Lexeme* lexeme);
+
+Node* nodeAt(const Ast* ast, NodeIndex index);
+
+// Appends 'child' behind 'last', the last child of 'parent' so far
+void appendChild(Ast* ast, NodeIndex parent, NodeIndex* last, NodeIndex child);
+
+size_t nodeCount(const Ast* ast);
+
+// Returns 0 if out of memory
+ExpressionIndex addExpression(Ast* ast, ExpressionKind kind, const Lexeme* lexeme, ExpressionIndex left, ExpressionIndex right);
+
+Expression* expressionAt(const Ast* ast, ExpressionIndex index);
+
+// Initial capacity of the stack of printAst, doubles when full
+#define AST_PRINT_STACK_SIZE 64
+
+// Returns false if out of memory
+bool printAst(const Ast* ast, const Interner* interner);
 
-#endif // HEADER_AST
\ No newline at end of file
+#endif  // HEADER_AST
@@ -0,0 +1,269 @@
+#include "expression.h"
+#include "../lexer/keywords.h"
+#include <stdlib.h>
+
+// Lowest to highest
+#define PRECEDENCE_OR 1
+#define PRECEDENCE_AND 2
+#define PRECEDENCE_NOT 3
+#define PRECEDENCE_COMPARISON 4
+#define PRECEDENCE_BITWISE_OR 5
+#define PRECEDENCE_BITWISE_XOR 6
+#define PRECEDENCE_BITWISE_AND 7
+#define PRECEDENCE_ADDITION 8
+#define PRECEDENCE_MULTIPLICATION 9
+#define PRECEDENCE_PREFIX 10
+#define PRECEDENCE_POWER 11
+
+/*
+ * Private helpers
+ */
+
+unsigned binaryPrecedence(const Lexeme* lexeme)
+{
+    if(lexeme->tok == TKKeyword)
+    {
+        if(lexeme->value == KWOr)
+            return PRECEDENCE_OR;
+        if(lexeme->value == KWAnd)
+            return PRECEDENCE_AND;
+        if(lexeme->value == KWIs)
+            return PRECEDENCE_COMPARISON;
+        return 0;
+    }
+
+    switch(lexeme->tok)
+    {
+        case TKOperatorEqual:
+        case TKOperatorGreaterThan:
+        case TKOperatorGreaterEqual:
+        case TKOperatorLessThan:
+        case TKOperatorLessEqual:
+            return PRECEDENCE_COMPARISON;
+        case TKOperatorOR:
+            return PRECEDENCE_BITWISE_OR;
+        case TKOperatorXOR:
+            return PRECEDENCE_BITWISE_XOR;
+        case TKOperatorAND:
+            return PRECEDENCE_BITWISE_AND;
+        case TKOperatorAddition:
+        case TKOperatorSubtraction:
+            return PRECEDENCE_ADDITION;
+        case TKOperatorMultiplication:
+        case TKOperatorDivision:
+        case TKOperatorFloorDivision:
+        case TKOperatorModulo:
+            return PRECEDENCE_MULTIPLICATION;
+        case TKOperatorPower:
+            return PRECEDENCE_POWER;
+        default:
+            return 0;
+    }
+}
+
+unsigned prefixPrecedence(const Lexeme* lexeme)
+{
+    if(lexeme->tok == TKKeyword && lexeme->value == KWNot)
+        return PRECEDENCE_NOT;
+    if(lexeme->tok == TKOperatorSubtraction || lexeme->tok == TKOperatorCOMP)
+        return PRECEDENCE_PREFIX;
+    return 0;
+}
+
+bool isOperand(Token tok)
+{
+    return tok == TKIdentifier || tok == TKBinaryConstant || tok == TKHexadecimalConstant ||
+           tok == TKDecimalConstant || tok == TKFloatConstant || tok == TKBooleanConstant ||
+           tok == TKNilConstant || tok == TKCharacterConstant || tok == TKStringConstant;
+}
+
+bool pushOperand(ExpressionParser* parser, ExpressionIndex operand)
+{
+    if(operand == 0)
+        return false;
+
+    if(parser->operandCount == parser->operandCapacity)
+    {
+        size_t           capacity = parser->operandCapacity * 2;
+        ExpressionIndex* operands = realloc(parser->operands, capacity * sizeof(ExpressionIndex));
+        if(operands == NULL)
+            return false;
+
+        parser->operands        = operands;
+        parser->operandCapacity = capacity;
+    }
+
+    parser->operands[parser->operandCount++] = operand;
+    return true;
+}
+
+bool pushOperator(ExpressionParser* parser, const Lexeme* lexeme, unsigned precedence, bool unary)
+{
+    if(parser->operatorCount == parser->operatorCapacity)
+    {
+        size_t           capacity  = parser->operatorCapacity * 2;
+        PendingOperator* operators = realloc(parser->operators, capacity * sizeof(PendingOperator));
+        if(operators == NULL)
+            return false;
+
+        parser->operators        = operators;
+        parser->operatorCapacity = capacity;
+    }
+
+    PendingOperator* pending = &parser->operators[parser->operatorCount++];
+    pending->tok             = (uint8_t)lexeme->tok;
+    pending->precedence      = (uint8_t)precedence;
+    pending->unary           = unary;
+    pending->offset          = (uint32_t)lexeme->offset;
+    pending->length          = lexeme->length;
+    pending->value           = lexeme->value;
+    return true;
+}
+
+// Pops the top operator with its operands and emits it behind them
+bool reduce(ExpressionParser* parser, Ast* ast)
+{
+    PendingOperator* pending  = &parser->operators[--parser->operatorCount];
+    size_t           operands = pending->unary ? 1 : 2;
+    if(parser->operandCount < operands)
+        return false;
+
+    Lexeme lexeme;
+    lexeme.tok    = (Token)pending->tok;
+    lexeme.flags  = 0;
+    lexeme.value  = pending->value;
+    lexeme.offset = pending->offset;
+    lexeme.length = pending->length;
+    lexeme.text   = NULL;
+
+    parser->operandCount -= operands;
+    ExpressionIndex* top = &parser->operands[parser->operandCount];
+
+    ExpressionIndex expression = pending->unary ? addExpression(ast, EXUnary, &lexeme, top[0], 0)
+                                                : addExpression(ast, EXBinary, &lexeme, top[0], top[1]);
+    return pushOperand(parser, expression);
+}
+
+/*
+ * Expression parser
+ */
+
+void initializeExpressionParser(ExpressionParser* parser)
+{
+    parser->operatorCapacity = 16;
+    parser->operators        = malloc(parser->operatorCapacity * sizeof(PendingOperator));
+    parser->operandCapacity  = 16;
+    parser->operands         = malloc(parser->operandCapacity * sizeof(ExpressionIndex));
+    beginExpression(parser);
+}
+
+void finalizeExpressionParser(ExpressionParser* parser)
+{
+    free(parser->operators);
+    free(parser->operands);
+    parser->operators        = NULL;
+    parser->operands         = NULL;
+    parser->operatorCapacity = 0;
+    parser->operandCapacity  = 0;
+}
+
+void beginExpression(ExpressionParser* parser)
+{
+    parser->operatorCount = 0;
+    parser->operandCount  = 0;
+    parser->expectOperand = true;
+    parser->parentheses   = 0;
+    parser->start         = 0;
+    parser->end           = 0;
+}
+
+ExpressionStep feedExpression(ExpressionParser* parser, Ast* ast, const Lexeme* lexeme, ExpressionIndex* root)
+{
+    if(parser->operators == NULL || parser->operands == NULL)
+        return ESFailed;
+
+    if(parser->operandCount == 0 && parser->operatorCount == 0)
+        parser->start = (uint32_t)lexeme->offset;
+
+    if(parser->expectOperand)
+    {
+        unsigned precedence = prefixPrecedence(lexeme);
+
+        if(isOperand(lexeme->tok))
+        {
+            ExpressionKind kind = lexeme->tok == TKIdentifier ? EXIdentifier : EXConstant;
+            if(!pushOperand(parser, addExpression(ast, kind, lexeme, 0, 0)))
+                return ESFailed;
+            parser->expectOperand = false;
+        }
+        else if(precedence > 0)
+        {
+            if(!pushOperator(parser, lexeme, precedence, true))
+                return ESFailed;
+        }
+        else if(lexeme->tok == TKExpressionBegin)
+        {
+            if(!pushOperator(parser, lexeme, 0, false))
+                return ESFailed;
+            parser->parentheses++;
+        }
+        else
+        {
+            return ESFailed;
+        }
+
+        parser->end = (uint32_t)(lexeme->offset + lexeme->length);
+        return ESConsumed;
+    }
+
+    unsigned precedence = binaryPrecedence(lexeme);
+    if(precedence > 0)
+    {
+        // Higher precedence first, equal precedence from the left except for powers
+        while(parser->operatorCount > 0)
+        {
+            unsigned top = parser->operators[parser->operatorCount - 1].precedence;
+            if(top < precedence || (top == precedence && precedence == PRECEDENCE_POWER))
+                break;
+            if(!reduce(parser, ast))
+                return ESFailed;
+        }
+
+        if(!pushOperator(parser, lexeme, precedence, false))
+            return ESFailed;
+
+        parser->expectOperand = true;
+        parser->end           = (uint32_t)(lexeme->offset + lexeme->length);
+        return ESConsumed;
+    }
+
+    if(lexeme->tok == TKExpressionEnd && parser->parentheses > 0)
+    {
+        while(parser->operators[parser->operatorCount - 1].precedence != 0)
+        {
+            if(!reduce(parser, ast))
+                return ESFailed;
+        }
+
+        parser->operatorCount--;
+        parser->parentheses--;
+        parser->end = (uint32_t)(lexeme->offset + lexeme->length);
+        return ESConsumed;
+    }
+
+    // Any other token ends the expression
+    if(parser->parentheses > 0)
+        return ESFailed;
+
+    while(parser->operatorCount > 0)
+    {
+        if(!reduce(parser, ast))
+            return ESFailed;
+    }
+
+    if(parser->operandCount != 1)
+        return ESFailed;
+
+    *root = parser->operands[0];
+    return ESFinished;
+}
@@ -0,0 +1,54 @@
+#ifndef HEADER_EXPRESSION
+#define HEADER_EXPRESSION
+
+#include "../lexer/tokens.h"
+#include "ast.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Expression parser
+ */
+
+// Operator precedence parsing one token at a time with explicit stacks, no recursion
+typedef enum ExpressionStep
+{
+    ESConsumed,  // Token belongs to the expression
+    ESFinished,  // Token follows the expression and was not consumed
+    ESFailed,
+} ExpressionStep;
+
+typedef struct PendingOperator
+{
+    uint8_t  tok;
+    uint8_t  precedence;  // 0 for open parentheses
+    bool     unary;
+    uint32_t offset;
+    uint32_t length;
+    uint64_t value;
+} PendingOperator;
+
+typedef struct ExpressionParser
+{
+    PendingOperator* operators;
+    size_t           operatorCount;
+    size_t           operatorCapacity;
+    ExpressionIndex* operands;
+    size_t           operandCount;
+    size_t           operandCapacity;
+    bool             expectOperand;
+    unsigned         parentheses;
+    uint32_t         start;  // Source span of the whole expression
+    uint32_t         end;
+} ExpressionParser;
+
+void initializeExpressionParser(ExpressionParser* parser);
+
+void finalizeExpressionParser(ExpressionParser* parser);
+
+void beginExpression(ExpressionParser* parser);
+
+// Sets 'root' when the expression is finished
+ExpressionStep feedExpression(ExpressionParser* parser, Ast* ast, const Lexeme* lexeme, ExpressionIndex* root);
+
+#endif  // HEADER_EXPRESSION
@@ -0,0 +1,198 @@
+#include "grammar.h"
+
+// The grammar, compiled into the tables below:
+//
+//   statement  = "nop" | variable "=" (expression | fun | mod) | dat | fun | if | for | while | mod | ret | use
+//   variable   = identifier [":" type]
+//   dat        = "dat" identifier variable {"," variable} "end"
+//   fun        = "fun" [identifier] "(" [variable {"," variable}] ")" {statement} "end"
+//   if         = "if" expression {statement} {"elif" expression {statement}} ["else" {statement}] "end"
+//   for        = "for" identifier "in" expression {statement} "end"
+//   while      = "while" expression {statement} "end"
+//   mod        = "mod" {statement} "end"
+//   ret        = "ret" [expression]
+//   use        = "use" identifier
+//   expression = operand | prefix expression | expression binary expression | "(" expression ")"
+//   operand    = identifier | constant
+//
+// Expressions are handed to the operator precedence parser in expression.c.
+//
+// Variables are parsed by the ASTVariableWithType states, which return to the
+// state they were entered from. Without a type that state takes the token after
+// the name, so no look ahead is needed.
+
+/*
+ * Terminals
+ */
+
+const unsigned char tokenTerminals[TKCount] = {
+    [TKIdentifier]          = TRIdentifier,
+    [TKBinaryConstant]      = TRConstant,
+    [TKHexadecimalConstant] = TRConstant,
+    [TKDecimalConstant]     = TRConstant,
+    [TKFloatConstant]       = TRConstant,
+    [TKBooleanConstant]     = TRConstant,
+    [TKNilConstant]         = TRConstant,
+    [TKStringConstant]      = TRConstant,
+    [TKCharacterConstant]   = TRConstant,
+    [TKType]                = TRType,
+    [TKNop]                 = TRNop,
+    [TKAssignment]          = TRAssignment,
+    [TKOperatorSubtraction] = TRPrefix,
+    [TKOperatorCOMP]        = TRPrefix,
+    [TKColonSeparator]      = TRColon,
+    [TKCommaSeparator]      = TRComma,
+    [TKExpressionBegin]     = TRParenthesisOpen,
+    [TKExpressionEnd]       = TRParenthesisClose,
+};
+
+const unsigned char keywordTerminals[KWCount] = {
+    [KWDat]   = TRDat,
+    [KWFun]   = TRFun,
+    [KWIf]    = TRIf,
+    [KWElif]  = TRElif,
+    [KWElse]  = TRElse,
+    [KWFor]   = TRFor,
+    [KWIn]    = TRIn,
+    [KWWhile] = TRWhile,
+    [KWMod]   = TRMod,
+    [KWRet]   = TRRet,
+    [KWUse]   = TRUse,
+    [KWEnd]   = TREnd,
+    [KWNot]   = TRPrefix,
+};
+
+Terminal terminalOf(const Lexeme* lexeme)
+{
+    if(lexeme->tok == TKKeyword)
+        return (Terminal)keywordTerminals[lexeme->value];
+    return (Terminal)tokenTerminals[lexeme->tok];
+}
+
+/*
+ * Actions
+ */
+
+const ParserEntry parserActions[ASTCount][TRCount] = {
+    // Statements
+    [ASTUndefined] =
+        {
+            [TRNop]        = {PAStatement, ASTUndefined, NDNop},
+            [TRIdentifier] = {PAVariable, ASTAssignmentStatement, NDAssignment},
+            [TRDat]        = {PABlock, ASTDatStatement, NDDat},
+            [TRFun]        = {PABlock, ASTFunStatement, NDFun},
+            [TRIf]         = {PAIf, ASTIfStatement, NDIf},
+            [TRFor]        = {PABlock, ASTForStatement, NDFor},
+            [TRWhile]      = {PABlock, ASTWhileStatement, NDWhile},
+            [TRMod]        = {PABlockBody, ASTModStatementBody, NDMod},
+            [TRRet]        = {PAStatement, ASTReturnStatement, NDReturn},
+            [TRUse]        = {PAStatement, ASTUseStatement, NDUse},
+        },
+
+    // Identifier with type
+    [ASTVariableWithTypeName]  = {[TRColon] = {PAGoto, ASTVariableWithTypeColon}},
+    [ASTVariableWithTypeColon] = {[TRType] = {PAType, ASTHelper}},
+
+    // Assignment statement
+    [ASTAssignmentStatement] = {[TRAssignment] = {PAGoto, ASTAssignmentStatementAssign}},
+    [ASTAssignmentStatementAssign] =
+        {
+            [TRIdentifier]      = {PAValue, ASTUndefined},
+            [TRConstant]        = {PAValue, ASTUndefined},
+            [TRPrefix]          = {PAValue, ASTUndefined},
+            [TRParenthesisOpen] = {PAValue, ASTUndefined},
+            [TRFun]             = {PAFunValue, ASTFunStatement, NDFun},
+            [TRMod]             = {PAModValue, ASTModStatementBody, NDMod},
+        },
+
+    // Dat statement
+    [ASTDatStatement]     = {[TRIdentifier] = {PAName, ASTDatStatementName}},
+    [ASTDatStatementName] = {[TRIdentifier] = {PAVariable, ASTDatStatementIdentifier, NDField}},
+    [ASTDatStatementIdentifier] =
+        {
+            [TRComma] = {PAGoto, ASTDatStatementName},
+            [TREnd]   = {PAClose, ASTUndefined},
+        },
+
+    // Function statement
+    [ASTFunStatement] =
+        {
+            [TRIdentifier]      = {PAName, ASTFunStatementName},
+            [TRParenthesisOpen] = {PAGoto, ASTFunStatementArgs},
+        },
+    [ASTFunStatementName] = {[TRParenthesisOpen] = {PAGoto, ASTFunStatementArgs}},
+    [ASTFunStatementArgs] =
+        {
+            [TRIdentifier]       = {PAVariable, ASTFunStatementComma, NDParameter},
+            [TRParenthesisClose] = {PAEnter, ASTFunStatementEnd},
+        },
+    [ASTFunStatementComma] =
+        {
+            [TRComma]            = {PAGoto, ASTFunStatementArgs},
+            [TRParenthesisClose] = {PAEnter, ASTFunStatementEnd},
+        },
+    [ASTFunStatementEnd] = {[TREnd] = {PAClose, ASTUndefined}},
+
+    // If statement, each branch is a block inside the if block
+    [ASTIfStatement] =
+        {
+            [TRIdentifier]      = {PACondition, ASTIfStatementBody},
+            [TRConstant]        = {PACondition, ASTIfStatementBody},
+            [TRPrefix]          = {PACondition, ASTIfStatementBody},
+            [TRParenthesisOpen] = {PACondition, ASTIfStatementBody},
+        },
+    [ASTIfStatementBody] =
+        {
+            [TRElif] = {PABranch, ASTIfStatement, NDBranch},
+            [TRElse] = {PABranchBody, ASTIfStatementElse, NDElse},
+            [TREnd]  = {PACloseIf, ASTUndefined},
+        },
+    [ASTIfStatementElse] = {[TREnd] = {PACloseIf, ASTUndefined}},
+
+    // For statement
+    [ASTForStatement]     = {[TRIdentifier] = {PAName, ASTForStatementName}},
+    [ASTForStatementName] = {[TRIn] = {PAGoto, ASTForStatementIn}},
+    [ASTForStatementIn] =
+        {
+            [TRIdentifier]      = {PACondition, ASTForStatementBody},
+            [TRConstant]        = {PACondition, ASTForStatementBody},
+            [TRPrefix]          = {PACondition, ASTForStatementBody},
+            [TRParenthesisOpen] = {PACondition, ASTForStatementBody},
+        },
+    [ASTForStatementBody] = {[TREnd] = {PAClose, ASTUndefined}},
+
+    // While statement
+    [ASTWhileStatement] =
+        {
+            [TRIdentifier]      = {PACondition, ASTWhileStatementBody},
+            [TRConstant]        = {PACondition, ASTWhileStatementBody},
+            [TRPrefix]          = {PACondition, ASTWhileStatementBody},
+            [TRParenthesisOpen] = {PACondition, ASTWhileStatementBody},
+        },
+    [ASTWhileStatementBody] = {[TREnd] = {PAClose, ASTUndefined}},
+
+    // Mod statement
+    [ASTModStatementBody] = {[TREnd] = {PAClose, ASTUndefined}},
+
+    // Use statement, the module is named by the interface it is loaded from
+    [ASTUseStatement] = {[TRIdentifier] = {PAName, ASTUndefined}},
+
+    // Return statement, the value is optional
+    [ASTReturnStatement] =
+        {
+            [TRIdentifier]      = {PAValue, ASTUndefined},
+            [TRConstant]        = {PAValue, ASTUndefined},
+            [TRPrefix]          = {PAValue, ASTUndefined},
+            [TRParenthesisOpen] = {PAValue, ASTUndefined},
+        },
+};
+
+const ParserEntry parserDefaults[ASTCount] = {
+    // Tokens ending a body belong to the enclosing statement
+    [ASTUndefined] = {PARecover},
+
+    // Variables without a type
+    [ASTVariableWithTypeName] = {PARecover},
+
+    [ASTReturnStatement] = {PAFinish, ASTUndefined},
+};
@@ -0,0 +1,88 @@
+#ifndef HEADER_GRAMMAR
+#define HEADER_GRAMMAR
+
+#include "../lexer/keywords.h"
+#include "../lexer/tokens.h"
+#include "parser.h"
+#include <stdint.h>
+
+/*
+ * Terminals
+ */
+
+// Tokens as the grammar sees them, keywords are told apart
+typedef enum Terminal
+{
+    TROther,
+    TRIdentifier,
+    TRConstant,
+    TRPrefix,
+    TRType,
+    TRNop,
+    TRAssignment,
+    TRColon,
+    TRComma,
+    TRParenthesisOpen,
+    TRParenthesisClose,
+    TRDat,
+    TRFun,
+    TRIf,
+    TRElif,
+    TRElse,
+    TRFor,
+    TRIn,
+    TRWhile,
+    TRMod,
+    TRRet,
+    TRUse,
+    TREnd,
+    TRCount
+} Terminal;
+
+extern const unsigned char tokenTerminals[TKCount];
+
+extern const unsigned char keywordTerminals[KWCount];
+
+Terminal terminalOf(const Lexeme* lexeme);
+
+/*
+ * Actions
+ */
+
+typedef enum ParserAction
+{
+    PAError,
+    PAGoto,       // Go to 'next'
+    PAEnter,      // Parse statements, continue with 'next' on the first unknown token
+    PARecover,    // Return to the enclosing state and parse the token there
+    PAFinish,     // Go to 'next' and parse the token there
+    PAName,       // Name the current node
+    PAType,       // Declared type of the current variable
+    PAStatement,  // Add a 'node' to the block and make it current
+    PAVariable,   // Add a 'node' and parse its optional type, then 'next'
+    PABlock,      // Add a 'node' taking statements
+    PABlockBody,  // Add a 'node' and enter its body
+    PAIf,         // Add an if with its first branch
+    PABranch,     // Replace the open branch by a 'node'
+    PABranchBody, // Replace the open branch by a 'node' and enter its body
+    PACondition,  // Parse an expression into the block and enter its body
+    PAValue,      // Parse an expression as value of the current node
+    PAFunValue,   // Add a function as value of the current node
+    PAModValue,   // Add a module as value of the current node and enter its body
+    PAClose,      // Close the block
+    PACloseIf,    // Close the branch and the if
+} ParserAction;
+
+typedef struct ParserEntry
+{
+    uint8_t action;
+    uint8_t next;  // ASTState
+    uint8_t node;  // NodeKind
+} ParserEntry;
+
+// Entry for each state and terminal, PAError falls back to the default of the state
+extern const ParserEntry parserActions[ASTCount][TRCount];
+
+extern const ParserEntry parserDefaults[ASTCount];
+
+#endif  // HEADER_GRAMMAR
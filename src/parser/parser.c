@@ -1,8 +1,7 @@
 #include "parser.h"
-#include "../lexer/keywords.h"
-#include "../lexer/types.h"
+#include "grammar.h"
 #include <stdio.h>
-#include <string.h>
+#include <stdlib.h>
 
 /*
  * Private helpers
@@ -16,6 +15,17 @@ bool setState(Parser* parser, ASTState state)
 
 bool push(Parser* parser, ASTState current, ASTState new)
 {
+    if(parser->scope + 1 == parser->scopeCapacity)
+    {
+        size_t    capacity = parser->scopeCapacity * 2;
+        ASTState* stack    = realloc(parser->stack, capacity * sizeof(ASTState));
+        if(stack == NULL)
+            return setState(parser, ASTInvalid);
+
+        parser->stack         = stack;
+        parser->scopeCapacity = capacity;
+    }
+
     parser->scope += 1;
     parser->stack[parser->scope] = current;
     return setState(parser, new);
@@ -28,19 +38,155 @@ ASTState pop(Parser* parser)
     return parser->state;
 }
 
+// Appends a new node to the innermost open block
+NodeIndex addToBlock(Parser* parser, NodeKind kind, const Lexeme* lexeme)
+{
+    NodeIndex node = addNode(parser->ast, kind, lexeme);
+    if(node != NODE_NONE)
+    {
+        OpenBlock* block = &parser->blocks[parser->depth];
+        appendChild(parser->ast, block->node, &block->last, node);
+    }
+    return node;
+}
+
+// Following nodes are appended to 'node' until the block is closed
+bool openBlock(Parser* parser, NodeIndex node)
+{
+    if(node == NODE_NONE)
+        return setState(parser, ASTInvalid);
+
+    if(parser->depth + 1 == parser->blockCapacity)
+    {
+        size_t     capacity = parser->blockCapacity * 2;
+        OpenBlock* blocks   = realloc(parser->blocks, capacity * sizeof(OpenBlock));
+        if(blocks == NULL)
+            return setState(parser, ASTInvalid);
+
+        parser->blocks        = blocks;
+        parser->blockCapacity = capacity;
+    }
+
+    parser->depth += 1;
+    parser->blocks[parser->depth].node = node;
+    parser->blocks[parser->depth].last = NODE_NONE;
+    return true;
+}
+
+void closeBlock(Parser* parser)
+{
+    parser->depth -= 1;
+}
+
+// Attaches a finished expression and continues with the statement it belongs to
+bool finishExpression(Parser* parser, ExpressionIndex root)
+{
+    NodeIndex node = addNode(parser->ast, NDExpression, NULL);
+    if(node == NODE_NONE)
+        return setState(parser, ASTInvalid);
+
+    Node* expression   = nodeAt(parser->ast, node);
+    expression->offset = parser->expression.start;
+    expression->length = parser->expression.end - parser->expression.start;
+    expression->value  = root;
+
+    if(parser->pending == PACondition)
+    {
+        OpenBlock* block = &parser->blocks[parser->depth];
+        appendChild(parser->ast, block->node, &block->last, node);
+        return push(parser, parser->resume, ASTUndefined);
+    }
+
+    // Constants out of range of the declared type
+    const Expression* value = expressionAt(parser->ast, root);
+    if(nodeAt(parser->ast, parser->node)->kind == NDAssignment && parser->type != TYNone &&
+       value->kind == EXConstant && !fitsType(parser->type, (Token)value->tok, value->value))
+        return setState(parser, ASTInvalid);
+
+    nodeAt(parser->ast, parser->node)->first = node;
+    return setState(parser, parser->resume);
+}
+
+// Variables with a name, their optional type is set by the helper states
+bool addVariable(Parser* parser, NodeKind kind, const Lexeme* lexeme, ASTState state)
+{
+    parser->node = addToBlock(parser, kind, lexeme);
+    if(parser->node == NODE_NONE)
+        return setState(parser, ASTInvalid);
+
+    parser->type = TYNone;
+
+    nodeAt(parser->ast, parser->node)->name = (SymbolId)lexeme->value;
+    return push(parser, state, ASTVariableWithTypeName);
+}
+
+// Statements with a body of statements
+bool addBlock(Parser* parser, NodeKind kind, const Lexeme* lexeme, ASTState state)
+{
+    parser->node = addToBlock(parser, kind, lexeme);
+    if(!openBlock(parser, parser->node))
+        return false;
+    return setState(parser, state);
+}
+
+
 /*
  * Parser
  */
 
-void initializeParser(Parser* parser)
+bool initializeParser(Parser* parser, Ast* ast)
+{
+    parser->scopeCapacity = PARSER_STACK_SIZE;
+    parser->stack         = malloc(parser->scopeCapacity * sizeof(ASTState));
+    parser->blockCapacity = PARSER_STACK_SIZE;
+    parser->blocks        = malloc(parser->blockCapacity * sizeof(OpenBlock));
+    initializeExpressionParser(&parser->expression);
+
+    if(parser->stack == NULL || parser->blocks == NULL)
+    {
+        finalizeParser(parser);
+        return false;
+    }
+
+    resetParser(parser, ast);
+    return true;
+}
+
+void resetParser(Parser* parser, Ast* ast)
 {
     parser->state = ASTUndefined;
-    memset(parser->stack, ASTUndefined, MAX_SCOPES);
     parser->scope = 0;
+    parser->type  = TYNone;
+
+    parser->ast   = ast;
+    parser->node  = NODE_NONE;
+    parser->depth = 0;
+
+    parser->pending = PAError;
+    parser->resume  = ASTUndefined;
+
+    parser->stack[0]       = ASTUndefined;
+    parser->blocks[0].node = ast->root;
+    parser->blocks[0].last = NODE_NONE;
+}
+
+void finalizeParser(Parser* parser)
+{
+    finalizeExpressionParser(&parser->expression);
+    free(parser->stack);
+    free(parser->blocks);
+    parser->stack         = NULL;
+    parser->blocks        = NULL;
+    parser->scopeCapacity = 0;
+    parser->blockCapacity = 0;
 }
 
-bool parse(Parser* parser, Token tok, const char* word)
+bool parse(Parser* parser, TokenRing* tokens)
 {
+    Lexeme        current = consumeToken(tokens);
+    const Lexeme* lexeme  = &current;
+    Token         tok     = lexeme->tok;
+
     // Recover previous scope
     if(parser->state == ASTHelper && parser->scope > 0)
     {
@@ -52,128 +198,135 @@ bool parse(Parser* parser, Token tok, const char* word)
         return setState(parser, ASTInvalid);
     }
 
-    else if(tok == TKEnd)
-    {
-        setState(parser, ASTEnd);
-        return false;
-    }
-
     else if(tok == TKComment || tok == TKEmpty)
         return setState(parser, parser->state);
-    
-    /*
-     * Helper states
-     */
-    
-    // Identifier with type
-    else if(parser->state == ASTVariableWithTypeName)
-    {
-        if(tok == TKColonSeparator)
-            return setState(parser, ASTVariableWithTypeColon);
-    }
-    else if(parser->state == ASTVariableWithTypeColon)
-    {
-        if(tok == TKType)
-            return setState(parser, ASTHelper);
-    }
-
-    /*
-     * Statement states
-     */
 
-    // New statement
-    else if(parser->state == ASTUndefined)
+    // Actions handing the token on to another state loop instead of recursing
+    for(;;)
     {
-        // Nop
-        if(tok == TKNop)
-            return setState(parser, ASTUndefined);
-
-        // Assignment
-        else if(tok == TKIdentifier)
-            return push(parser, ASTAssignmentStatement, ASTVariableWithTypeName);
-
-        // * Statement
-        else if(tok == TKKeyword)
+        // Expressions take tokens until one does not fit, which then continues the statement
+        if(parser->state == ASTExpression)
         {
-            if(strcmp(word, DAT) == 0)
-                return setState(parser, ASTDatStatement);
+            ExpressionIndex root;
+            ExpressionStep  step = feedExpression(&parser->expression, parser->ast, lexeme, &root);
+            if(step == ESConsumed)
+                return true;
+            if(step == ESFailed || !finishExpression(parser, root))
+                return setState(parser, ASTInvalid);
         }
 
-        // Recover previous scope
-        if(parser->scope > 0)
+        if(tok == TKEnd)
         {
-            pop(parser);
-            return parse(parser, tok, word);
+            setState(parser, ASTEnd);
+            return false;
         }
-    }
 
-    // Dat statement
-    else if(parser->state == ASTDatStatement)
-    {
-        if(tok == TKIdentifier)
-            return setState(parser, ASTDatStatementName);
-    }
-    else if(parser->state == ASTDatStatementName)
-    {
-        if(tok == TKIdentifier)
-            return push(parser, ASTDatStatementIdentifier, ASTVariableWithTypeName);
-    }
-    else if(parser->state == ASTDatStatementIdentifier)
-    {
-        if(tok == TKCommaSeparator)
-            return setState(parser, ASTDatStatementName);
-        else if(tok == TKKeyword && strcmp(word, END) == 0)
-            return setState(parser, ASTUndefined);
-    }
+        // Constant time dispatch on state and terminal
+        const ParserEntry* entry = &parserActions[parser->state][terminalOf(lexeme)];
+        if(entry->action == PAError)
+            entry = &parserDefaults[parser->state];
 
-    // Assignment statement
-    else if(parser->state == ASTAssignmentStatement)
-    {
-        if(tok == TKAssignment)
-            return setState(parser, ASTAssignmentStatementAssign);
-    }
-    else if(parser->state == ASTAssignmentStatementAssign)
-    {
-        if(tok == TKBinaryConstant || tok == TKHexadecimalConstant || tok == TKDecimalConstant ||
-           tok == TKFloatConstant || tok == TKBooleanConstant || tok == TKNilConstant)
-            return setState(parser, ASTUndefined);
-        else if(tok == TKKeyword && strcmp(word, FUN) == 0)
-            return setState(parser, ASTFunStatement);
-    }
+        ASTState next = (ASTState)entry->next;
+        NodeKind kind = (NodeKind)entry->node;
 
-    // Function Statement
-    else if(parser->state == ASTFunStatement)
-    {
-        if(tok == TKIdentifier)
-            return setState(parser, ASTFunStatementName);
-        else if(tok == TKExpressionBegin)
-            return setState(parser, ASTFunStatementArgs);
-    }
-    else if(parser->state == ASTFunStatementName)
-    {
-        if(tok == TKExpressionBegin)
-            return setState(parser, ASTFunStatementArgs);
-    }
-    else if(parser->state == ASTFunStatementArgs)
-    {
-        if(tok == TKIdentifier)
-            return push(parser, ASTFunStatementComma, ASTVariableWithTypeName);
-        else if(tok == TKExpressionEnd)
-            return push(parser, ASTFunStatementEnd, ASTUndefined);
-    }
-    else if(parser->state == ASTFunStatementComma)
-    {
-        if(tok == TKCommaSeparator)
-            return setState(parser, ASTFunStatementArgs);
-        else if(tok == TKExpressionEnd)
-            return push(parser, ASTFunStatementEnd, ASTUndefined);
-    }
-    else if(parser->state == ASTFunStatementEnd)
-    {
-        if(tok == TKKeyword && strcmp(word, END) == 0)
-            return setState(parser, ASTUndefined);
-    }
+        switch(entry->action)
+        {
+            case PAGoto:
+                return setState(parser, next);
+
+            case PAEnter:
+                return push(parser, next, ASTUndefined);
+
+            case PARecover:
+                if(parser->scope == 0)
+                    break;
+                pop(parser);
+                continue;
+
+            case PAFinish:
+                setState(parser, next);
+                continue;
+
+            case PAName:
+                nodeAt(parser->ast, parser->node)->name = (SymbolId)lexeme->value;
+                return setState(parser, next);
+
+            case PAType:
+                parser->type                            = (Type)lexeme->value;
+                nodeAt(parser->ast, parser->node)->type = (uint8_t)lexeme->value;
+                return setState(parser, next);
+
+            case PAStatement:
+                parser->node = addToBlock(parser, kind, lexeme);
+                if(parser->node == NODE_NONE)
+                    break;
+                return setState(parser, next);
+
+            case PAVariable:
+                return addVariable(parser, kind, lexeme, next);
 
-    // Error state
-    return setState(parser, ASTInvalid);
-}
\ No newline at end of file
+            case PABlock:
+                return addBlock(parser, kind, lexeme, next);
+
+            case PABlockBody:
+                if(!addBlock(parser, kind, lexeme, ASTUndefined))
+                    return false;
+                return push(parser, next, ASTUndefined);
+
+            case PAIf:
+                if(!addBlock(parser, kind, lexeme, next))
+                    return false;
+                return openBlock(parser, addToBlock(parser, NDBranch, lexeme));
+
+            case PABranch:
+            case PABranchBody:
+                closeBlock(parser);
+                if(!openBlock(parser, addToBlock(parser, kind, lexeme)))
+                    return false;
+                if(entry->action == PABranchBody)
+                    return push(parser, next, ASTUndefined);
+                return setState(parser, next);
+
+            case PACondition:
+            case PAValue:
+                // The expression parser takes over from this token on
+                parser->pending = entry->action;
+                parser->resume  = next;
+                beginExpression(&parser->expression);
+                setState(parser, ASTExpression);
+                continue;
+
+            case PAFunValue:
+            case PAModValue:
+            {
+                // The function or module is the value of the assignment
+                NodeIndex value = addNode(parser->ast, kind, lexeme);
+                if(value == NODE_NONE)
+                    break;
+
+                nodeAt(parser->ast, parser->node)->first = value;
+                parser->node                             = value;
+                if(!openBlock(parser, value))
+                    return false;
+                if(entry->action == PAModValue)
+                    return push(parser, next, ASTUndefined);
+                return setState(parser, next);
+            }
+
+            case PAClose:
+                closeBlock(parser);
+                return setState(parser, next);
+
+            case PACloseIf:
+                closeBlock(parser);
+                closeBlock(parser);
+                return setState(parser, next);
+
+            default:
+                break;
+        }
+
+        // Error state
+        return setState(parser, ASTInvalid);
+    }
+}
@@ -1,14 +1,18 @@
 #ifndef HEADER_PARSER
 #define HEADER_PARSER
 
+#include "../lexer/tokenring.h"
 #include "../lexer/tokens.h"
+#include "../lexer/types.h"
+#include "ast.h"
+#include "expression.h"
 #include <stdbool.h>
 
 /*
  * Parser
  */
 
-// A bad state machine
+// States of the table driven parser, see grammar.c
 typedef enum ASTState
 {
     ASTUndefined,
@@ -30,30 +34,73 @@ typedef enum ASTState
     ASTFunStatementComma,
     ASTFunStatementEnd,
 
+    ASTIfStatement,
+    ASTIfStatementBody,
+    ASTIfStatementElse,
+
+    ASTForStatement,
+    ASTForStatementName,
+    ASTForStatementIn,
+    ASTForStatementBody,
+
+    ASTWhileStatement,
+    ASTWhileStatementBody,
+
+    ASTModStatementBody,
+
+    ASTReturnStatement,
+
+    ASTUseStatement,
+
+    ASTExpression,
+
     ASTVariableWithTypeName,
     ASTVariableWithTypeColon,
     ASTVariableWithTypeType,
 
-    // ASTVariableOptionalTypeName, // TODO non-deterministic state (look ahead)
-    // ASTVariableOptionalTypeColon,
-    // ASTVariableOptionalTypeType,
-
     ASTInvalid,
-    ASTEnd
+    ASTEnd,
+    ASTCount
 } ASTState;
 
-#define MAX_SCOPES 64
+// Initial capacity of the scope and block stacks, both double when full
+#define PARSER_STACK_SIZE 64
+
+// Node taking statements and its last child
+typedef struct OpenBlock
+{
+    NodeIndex node;
+    NodeIndex last;
+} OpenBlock;
 
 typedef struct Parser
 {
-    ASTState state;
-    ASTState stack[MAX_SCOPES];
-    unsigned char scope;
+    ASTState  state;
+    ASTState* stack;  // States to return to when a scope ends
+    size_t    scope;
+    size_t    scopeCapacity;
+    Type      type;  // Declared type of the last variable
+
+    Ast*       ast;
+    NodeIndex  node;    // Variable or statement being built
+    OpenBlock* blocks;  // Open nodes taking statements
+    size_t     depth;
+    size_t     blockCapacity;
+
+    ExpressionParser expression;
+    unsigned char pending;  // Action the current expression is parsed for
+    ASTState resume;        // State after the expression
 } Parser;
 
-void initializeParser(Parser* parser);
+bool initializeParser(Parser* parser, Ast* ast);
+
+// Starts over on 'ast', keeping the memory of the stacks
+void resetParser(Parser* parser, Ast* ast);
+
+void finalizeParser(Parser* parser);
 
-bool parse(Parser* parser, Token tok, const char * word);
+// Parses the next token of the ring
+bool parse(Parser* parser, TokenRing* tokens);
 
 /*
  * Helper
@@ -0,0 +1,206 @@
+#include "sourcetree.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Private helpers
+ */
+
+bool reserveStatements(TopStatement** statements, size_t* capacity, size_t count)
+{
+    if(count <= *capacity && *statements != NULL)
+        return true;
+
+    size_t size = *capacity > 0 ? *capacity : 64;
+    while(size < count)
+        size *= 2;
+
+    TopStatement* grown = realloc(*statements, size * sizeof(TopStatement));
+    if(grown == NULL)
+        return false;
+
+    *statements = grown;
+    *capacity   = size;
+    return true;
+}
+
+// Replaces the statements from 'first' on with the fresh ones and the old ones from 'kept' on,
+// whose tokens moved by 'added' minus 'removed'
+bool spliceStatements(SourceTree* tree, size_t first, size_t kept, size_t added, size_t removed)
+{
+    size_t tail = tree->count - kept;
+    if(!reserveStatements(&tree->statements, &tree->capacity, first + tree->freshCount + tail))
+        return false;
+
+    memmove(tree->statements + first + tree->freshCount, tree->statements + kept, tail * sizeof(TopStatement));
+    memcpy(tree->statements + first, tree->fresh, tree->freshCount * sizeof(TopStatement));
+    tree->count = first + tree->freshCount + tail;
+
+    for(size_t i = tree->count - tail; i < tree->count; ++i)
+        tree->statements[i].token = tree->statements[i].token + added - removed;
+    return true;
+}
+
+// Parses from statement 'first' on. Tokens behind 'changed' are the old ones moved
+// by 'added' minus 'removed', a statement starting at one of them ends the reparse.
+bool reparse(SourceTree* tree, size_t first, size_t changed, size_t added, size_t removed)
+{
+    Parser* parser = &tree->parser;
+    Ast*    ast    = &tree->ast;
+
+    // The statements from 'first' on are unlinked, their nodes are garbage
+    resetParser(parser, ast);
+    if(first > 0)
+    {
+        parser->blocks[0].last                    = tree->statements[first - 1].node;
+        nodeAt(ast, parser->blocks[0].last)->next = NODE_NONE;
+    }
+    else
+        nodeAt(ast, ast->root)->first = NODE_NONE;
+
+    size_t         start  = first < tree->count ? tree->statements[first].token : 0;
+    size_t         old    = first;
+    DocumentReader reader = {&tree->document, start};
+    TokenRing      ring;
+    initializeTokenRing(&ring, documentSource, &reader);
+
+    tree->freshCount = 0;
+    tree->reparsed   = 0;
+    for(size_t token = start;; ++token)
+    {
+        NodeIndex last = parser->blocks[0].last;
+        bool      more = parse(parser, &ring);
+        tree->reparsed++;
+
+        if(parser->blocks[0].last != last)
+        {
+            // An old statement starts here, it and all behind it are parsed as before
+            while(old < tree->count && tree->statements[old].token + added < token + removed)
+                old++;
+            if(more && token > changed && old < tree->count && tree->statements[old].token + added == token + removed)
+            {
+                if(last != NODE_NONE)
+                    nodeAt(ast, last)->next = tree->statements[old].node;
+                else
+                    nodeAt(ast, ast->root)->first = tree->statements[old].node;
+
+                if(!tree->valid)
+                    tree->errorToken = tree->errorToken + added - removed;
+                return spliceStatements(tree, first, old, added, removed);
+            }
+
+            if(!reserveStatements(&tree->fresh, &tree->freshCapacity, tree->freshCount + 1))
+                return false;
+            tree->fresh[tree->freshCount].node  = parser->blocks[0].last;
+            tree->fresh[tree->freshCount].token = token;
+            tree->freshCount++;
+        }
+
+        if(!more)
+        {
+            tree->valid      = parser->state == ASTEnd;
+            tree->errorToken = token;
+            break;
+        }
+    }
+
+    return spliceStatements(tree, first, tree->count, added, removed);
+}
+
+// Builds the whole tree again, which also drops the garbage of earlier reparses
+bool rebuildTree(SourceTree* tree)
+{
+    if(!clearAst(&tree->ast))
+        return false;
+
+    tree->count   = 0;
+    tree->garbage = 0;
+    return reparse(tree, 0, 0, 0, 0);
+}
+
+/*
+ * Source tree
+ */
+
+bool openSourceTree(SourceTree* tree, const char* text, size_t size, Interner* interner)
+{
+    tree->statements    = NULL;
+    tree->count         = 0;
+    tree->capacity      = 0;
+    tree->fresh         = NULL;
+    tree->freshCount    = 0;
+    tree->freshCapacity = 0;
+    tree->valid         = false;
+    tree->errorToken    = 0;
+    tree->reparsed      = 0;
+    tree->garbage       = 0;
+
+    bool opened = openDocument(&tree->document, text, size, interner);
+    if(!initializeAst(&tree->ast))
+        opened = false;
+    if(!initializeParser(&tree->parser, &tree->ast))
+    {
+        finalizeAst(&tree->ast);
+        closeDocument(&tree->document);
+        return false;
+    }
+
+    return opened && rebuildTree(tree);
+}
+
+void closeSourceTree(SourceTree* tree)
+{
+    finalizeParser(&tree->parser);
+    finalizeAst(&tree->ast);
+    closeDocument(&tree->document);
+    free(tree->statements);
+    free(tree->fresh);
+    tree->statements    = NULL;
+    tree->fresh         = NULL;
+    tree->count         = 0;
+    tree->capacity      = 0;
+    tree->freshCapacity = 0;
+}
+
+bool editSourceTree(SourceTree* tree, const char* text, size_t size, size_t offset, size_t removed, size_t inserted)
+{
+    Document* document = &tree->document;
+    if(!editDocument(document, text, size, offset, removed, inserted))
+        return false;
+
+    // Only the text behind a lexer error changed
+    if(document->relexed == 0 && document->dropped == 0 && document->changed == documentTokenCount(document))
+    {
+        tree->reparsed = 0;
+        return true;
+    }
+
+    // Replaced statements are left in the arenas, once they could fill the tree again it is rebuilt
+    if(tree->garbage > documentTokenCount(document))
+        return rebuildTree(tree);
+
+    // A statement is parsed up to the first token of the next one, so the first statement
+    // touched is the one in front of the first starting behind the changed token
+    size_t low  = 0;
+    size_t high = tree->count;
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(tree->statements[middle].token < document->changed)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    // The token behind the new ones keeps its place but may have new flags
+    size_t changed  = document->changed + document->relexed;
+    bool   reparsed = reparse(tree, low > 0 ? low - 1 : 0, changed, document->relexed, document->dropped);
+    tree->garbage += tree->reparsed;
+    return reparsed;
+}
+
+ptrdiff_t statementShift(const SourceTree* tree, size_t statement)
+{
+    const TopStatement* top = &tree->statements[statement];
+    return (ptrdiff_t)documentToken(&tree->document, top->token).offset - (ptrdiff_t)nodeAt(&tree->ast, top->node)->offset;
+}
@@ -0,0 +1,50 @@
+#ifndef HEADER_SOURCETREE
+#define HEADER_SOURCETREE
+
+#include "../lexer/incremental.h"
+#include "ast.h"
+#include "parser.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Source tree
+ */
+
+// Statement of the module, where the parser is back at scope 0
+typedef struct TopStatement
+{
+    NodeIndex node;
+    size_t    token;  // Index of its first token
+} TopStatement;
+
+// Tree of a document edited in place. An edit reparses the top level statements
+// its tokens touch, the statements behind them are linked in again as they are.
+typedef struct SourceTree
+{
+    Document      document;
+    Ast           ast;
+    Parser        parser;
+    TopStatement* statements;  // In source order, like the children of the module
+    size_t        count;
+    size_t        capacity;
+    TopStatement* fresh;  // Statements of the current reparse
+    size_t        freshCount;
+    size_t        freshCapacity;
+    bool          valid;
+    size_t        errorToken;  // Token the parser failed on, unless valid
+    size_t        reparsed;    // Tokens parsed by the last edit
+    size_t        garbage;     // Tokens parsed since the tree was built from scratch
+} SourceTree;
+
+bool openSourceTree(SourceTree* tree, const char* text, size_t size, Interner* interner);
+
+void closeSourceTree(SourceTree* tree);
+
+// Arguments as for editDocument
+bool editSourceTree(SourceTree* tree, const char* text, size_t size, size_t offset, size_t removed, size_t inserted);
+
+// Nodes keep the offsets they were parsed at, statements reused behind an edit moved by this much
+ptrdiff_t statementShift(const SourceTree* tree, size_t statement);
+
+#endif  // HEADER_SOURCETREE
@@ -0,0 +1,61 @@
+#include "arena.h"
+#include <stdlib.h>
+
+/*
+ * Private helpers
+ */
+
+bool growArena(Arena* arena, size_t required)
+{
+    size_t capacity = arena->capacity > 0 ? arena->capacity : 4096;
+    while(capacity < required)
+        capacity *= 2;
+
+    char* data = realloc(arena->data, capacity);
+    if(data == NULL)
+        return false;
+
+    arena->data     = data;
+    arena->capacity = capacity;
+    return true;
+}
+
+/*
+ * Arena
+ */
+
+void initializeArena(Arena* arena, size_t capacity)
+{
+    arena->data     = NULL;
+    arena->size     = 0;
+    arena->capacity = 0;
+
+    if(capacity > 0)
+        growArena(arena, capacity);
+}
+
+void finalizeArena(Arena* arena)
+{
+    free(arena->data);
+    initializeArena(arena, 0);
+}
+
+void resetArena(Arena* arena)
+{
+    arena->size = 0;
+}
+
+size_t allocateArena(Arena* arena, size_t size, size_t alignment)
+{
+    size_t offset = (arena->size + alignment - 1) & ~(alignment - 1);
+    if(offset + size > arena->capacity && !growArena(arena, offset + size))
+        return ARENA_FAILED;
+
+    arena->size = offset + size;
+    return offset;
+}
+
+void* arenaAt(const Arena* arena, size_t offset)
+{
+    return arena->data + offset;
+}
@@ -0,0 +1,33 @@
+#ifndef HEADER_ARENA
+#define HEADER_ARENA
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Arena
+ */
+
+// One contiguous growing block, allocations are addressed by offset so they survive growing
+typedef struct Arena
+{
+    char*  data;
+    size_t size;
+    size_t capacity;
+} Arena;
+
+#define ARENA_FAILED ((size_t)-1)
+
+void initializeArena(Arena* arena, size_t capacity);
+
+void finalizeArena(Arena* arena);
+
+// Drops all allocations but keeps the memory for the next ones
+void resetArena(Arena* arena);
+
+// Returns the offset of 'size' bytes aligned to 'alignment' (a power of two) or ARENA_FAILED
+size_t allocateArena(Arena* arena, size_t size, size_t alignment);
+
+void* arenaAt(const Arena* arena, size_t offset);
+
+#endif  // HEADER_ARENA
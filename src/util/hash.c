@@ -0,0 +1,40 @@
+#include "hash.h"
+#include <string.h>
+
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15
+
+/*
+ * Private helpers
+ */
+
+uint64_t mixHash(uint64_t hash, uint64_t chunk)
+{
+    hash ^= chunk;
+    hash *= HASH_MULTIPLIER;
+    return hash ^ (hash >> 29);
+}
+
+/*
+ * Hashing
+ */
+
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed)
+{
+    const unsigned char* p    = data;
+    uint64_t             hash = seed ^ (length * HASH_MULTIPLIER);
+
+    for(; length >= 8; p += 8, length -= 8)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, p, sizeof(chunk));
+        hash = mixHash(hash, chunk);
+    }
+
+    // Tail bytes, at most seven
+    uint64_t tail = 0;
+    for(size_t i = 0; i < length; ++i)
+        tail |= (uint64_t)p[i] << (8 * i);
+
+    hash = mixHash(hash, tail);
+    return mixHash(hash, hash >> 32);
+}
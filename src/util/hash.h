@@ -0,0 +1,14 @@
+#ifndef HEADER_HASH
+#define HEADER_HASH
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hashing
+ */
+
+// Fast non-cryptographic hash, eight bytes per multiplication
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed);
+
+#endif  // HEADER_HASH
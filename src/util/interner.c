@@ -0,0 +1,134 @@
+#include "interner.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERNER_SLOTS 1024
+
+/*
+ * Private helpers
+ */
+
+bool growSlots(Interner* interner)
+{
+    uint32_t  mask  = interner->mask * 2 + 1;
+    SymbolId* slots = calloc((size_t)mask + 1, sizeof(SymbolId));
+    if(slots == NULL)
+        return false;
+
+    // Stored hashes spare hashing the text again
+    for(SymbolId symbol = 1; symbol < interner->count; ++symbol)
+    {
+        uint32_t slot = interner->strings[symbol].hash & mask;
+        while(slots[slot] != SYMBOL_NONE)
+            slot = (slot + 1) & mask;
+        slots[slot] = symbol;
+    }
+
+    free(interner->slots);
+    interner->slots = slots;
+    interner->mask  = mask;
+    return true;
+}
+
+bool growStrings(Interner* interner)
+{
+    uint32_t        capacity = interner->capacity * 2;
+    InternedString* strings  = realloc(interner->strings, capacity * sizeof(InternedString));
+    if(strings == NULL)
+        return false;
+
+    interner->strings  = strings;
+    interner->capacity = capacity;
+    return true;
+}
+
+/*
+ * String interner
+ */
+
+bool initializeInterner(Interner* interner)
+{
+    initializeArena(&interner->text, 16 * INTERNER_SLOTS);
+    interner->strings  = malloc(INTERNER_SLOTS * sizeof(InternedString));
+    interner->count    = 1;
+    interner->capacity = INTERNER_SLOTS;
+    interner->slots    = calloc(INTERNER_SLOTS, sizeof(SymbolId));
+    interner->mask     = INTERNER_SLOTS - 1;
+
+    if(interner->strings == NULL || interner->slots == NULL)
+    {
+        finalizeInterner(interner);
+        return false;
+    }
+
+    // SYMBOL_NONE is the empty string
+    interner->strings[SYMBOL_NONE].offset = 0;
+    interner->strings[SYMBOL_NONE].length = 0;
+    interner->strings[SYMBOL_NONE].hash   = 0;
+    return allocateArena(&interner->text, 1, 1) != ARENA_FAILED;
+}
+
+void finalizeInterner(Interner* interner)
+{
+    finalizeArena(&interner->text);
+    free(interner->strings);
+    free(interner->slots);
+
+    interner->strings  = NULL;
+    interner->count    = 0;
+    interner->capacity = 0;
+    interner->slots    = NULL;
+    interner->mask     = 0;
+}
+
+bool clearInterner(Interner* interner)
+{
+    memset(interner->slots, 0, ((size_t)interner->mask + 1) * sizeof(SymbolId));
+    interner->count = 1;
+
+    resetArena(&interner->text);
+    return allocateArena(&interner->text, 1, 1) != ARENA_FAILED;
+}
+
+SymbolId intern(Interner* interner, const char* text, size_t length)
+{
+    uint32_t hash = (uint32_t)hashBytes(text, length, 0);
+    uint32_t slot = hash & interner->mask;
+
+    for(SymbolId symbol; (symbol = interner->slots[slot]) != SYMBOL_NONE; slot = (slot + 1) & interner->mask)
+    {
+        const InternedString* string = &interner->strings[symbol];
+        if(string->hash == hash && string->length == length &&
+           memcmp(interner->text.data + string->offset, text, length) == 0)
+            return symbol;
+    }
+
+    // New string, the table stays at most half full
+    if(interner->count == interner->capacity && !growStrings(interner))
+        return SYMBOL_NONE;
+
+    size_t offset = allocateArena(&interner->text, length + 1, 1);
+    if(offset == ARENA_FAILED)
+        return SYMBOL_NONE;
+
+    memcpy(interner->text.data + offset, text, length);
+    interner->text.data[offset + length] = '\0';
+
+    SymbolId symbol                  = interner->count++;
+    interner->strings[symbol].offset = (uint32_t)offset;
+    interner->strings[symbol].length = (uint32_t)length;
+    interner->strings[symbol].hash   = hash;
+    interner->slots[slot]            = symbol;
+
+    if(2 * (size_t)interner->count > (size_t)interner->mask && !growSlots(interner))
+        return SYMBOL_NONE;
+
+    return symbol;
+}
+
+const char* symbolText(const Interner* interner, SymbolId symbol, unsigned* length)
+{
+    *length = interner->strings[symbol].length;
+    return interner->text.data + interner->strings[symbol].offset;
+}
@@ -0,0 +1,47 @@
+#ifndef HEADER_INTERNER
+#define HEADER_INTERNER
+
+#include "arena.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * String interner
+ */
+
+// Stable id of a distinct string, names compare by id
+typedef uint32_t SymbolId;
+
+#define SYMBOL_NONE 0
+
+typedef struct InternedString
+{
+    uint32_t offset;  // Text in the arena, zero terminated
+    uint32_t length;
+    uint32_t hash;
+} InternedString;
+
+typedef struct Interner
+{
+    Arena           text;
+    InternedString* strings;  // Indexed by id, 0 is SYMBOL_NONE
+    uint32_t        count;
+    uint32_t        capacity;
+    SymbolId*       slots;    // Open addressing with linear probing, 0 is empty
+    uint32_t        mask;     // Number of slots - 1
+} Interner;
+
+bool initializeInterner(Interner* interner);
+
+void finalizeInterner(Interner* interner);
+
+// Forgets all strings, the memory is kept for the next ones
+bool clearInterner(Interner* interner);
+
+// Returns the id of the text, adds it if it is new, SYMBOL_NONE if out of memory
+SymbolId intern(Interner* interner, const char* text, size_t length);
+
+// Valid until the next string is added
+const char* symbolText(const Interner* interner, SymbolId symbol, unsigned* length);
+
+#endif  // HEADER_INTERNER
@@ -0,0 +1,180 @@
+#include "pool.h"
+#include <stdlib.h>
+
+#define TASK_NONE SIZE_MAX
+
+/*
+ * Private helpers
+ */
+
+// Owner only, last in first out
+size_t takeTask(WorkDeque* deque)
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if(top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return TASK_NONE;
+    }
+
+    size_t task = atomic_load_explicit(&deque->tasks[bottom & deque->mask], memory_order_relaxed);
+    if(top == bottom)
+    {
+        // The last task, thieves may race for it
+        if(!atomic_compare_exchange_strong_explicit(
+               &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+            task = TASK_NONE;
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+// Any other worker, first in first out
+size_t stealTask(WorkDeque* deque)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if(top >= bottom)
+        return TASK_NONE;
+
+    size_t task = atomic_load_explicit(&deque->tasks[top & deque->mask], memory_order_relaxed);
+    if(!atomic_compare_exchange_strong_explicit(
+           &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        return TASK_NONE;
+    return task;
+}
+
+void runWorker(void* context)
+{
+    WorkDeque*  own  = context;
+    ThreadPool* pool = own->pool;
+
+    while(atomic_load_explicit(&pool->pending, memory_order_acquire) > 0)
+    {
+        size_t task = takeTask(own);
+
+        // Out of own work, take the oldest task of the next worker having one
+        for(unsigned i = 1; task == TASK_NONE && i < pool->count; ++i)
+            task = stealTask(&pool->deques[(own->worker + i) % pool->count]);
+
+        if(task == TASK_NONE)
+        {
+            yieldThread();
+            continue;
+        }
+
+        pool->run(pool->context, task, own->worker);
+        atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_release);
+    }
+}
+
+/*
+ * Work stealing pool
+ */
+
+bool initializeThreadPool(ThreadPool* pool, unsigned workers, size_t capacity, TaskRun run, void* context)
+{
+    size_t size = 16;
+    while(size < capacity)
+        size *= 2;
+
+    pool->count   = workers > 0 ? workers : 1;
+    pool->run     = run;
+    pool->context = context;
+    pool->deques  = calloc(pool->count, sizeof(WorkDeque));
+    pool->threads = calloc(pool->count, sizeof(Thread));
+    atomic_init(&pool->pending, 0);
+
+    if(pool->deques == NULL || pool->threads == NULL)
+    {
+        finalizeThreadPool(pool);
+        return false;
+    }
+
+    for(unsigned i = 0; i < pool->count; ++i)
+    {
+        WorkDeque* deque = &pool->deques[i];
+        deque->tasks     = malloc(size * sizeof(atomic_size_t));
+        deque->mask      = (int64_t)size - 1;
+        deque->pool      = pool;
+        deque->worker    = i;
+        atomic_init(&deque->top, 0);
+        atomic_init(&deque->bottom, 0);
+
+        if(deque->tasks == NULL)
+        {
+            finalizeThreadPool(pool);
+            return false;
+        }
+    }
+    return true;
+}
+
+void finalizeThreadPool(ThreadPool* pool)
+{
+    for(unsigned i = 0; pool->deques != NULL && i < pool->count; ++i)
+        free(pool->deques[i].tasks);
+
+    free(pool->deques);
+    free(pool->threads);
+    pool->deques  = NULL;
+    pool->threads = NULL;
+    pool->count   = 0;
+}
+
+bool reserveThreadPool(ThreadPool* pool, size_t capacity)
+{
+    for(unsigned i = 0; i < pool->count; ++i)
+    {
+        WorkDeque* deque = &pool->deques[i];
+        size_t     size  = (size_t)deque->mask + 1;
+        if(size >= capacity)
+            continue;
+
+        while(size < capacity)
+            size *= 2;
+
+        // Idle deques hold no tasks, the positions start over
+        atomic_size_t* tasks = realloc(deque->tasks, size * sizeof(atomic_size_t));
+        if(tasks == NULL)
+            return false;
+
+        deque->tasks = tasks;
+        deque->mask  = (int64_t)size - 1;
+        atomic_store_explicit(&deque->top, 0, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, 0, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool pushTask(ThreadPool* pool, unsigned worker, size_t task)
+{
+    WorkDeque* deque  = &pool->deques[worker];
+    int64_t    bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t    top    = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if(bottom - top > deque->mask)
+        return false;
+
+    atomic_fetch_add_explicit(&pool->pending, 1, memory_order_relaxed);
+    atomic_store_explicit(&deque->tasks[bottom & deque->mask], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+void runThreadPool(ThreadPool* pool)
+{
+    unsigned started = 1;
+    while(started < pool->count && startThread(&pool->threads[started], runWorker, &pool->deques[started]))
+        started++;
+
+    runWorker(&pool->deques[0]);
+
+    for(unsigned i = 1; i < started; ++i)
+        joinThread(&pool->threads[i]);
+}
@@ -0,0 +1,52 @@
+#ifndef HEADER_POOL
+#define HEADER_POOL
+
+#include "thread.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Work stealing pool
+ */
+
+// Runs task 'task' on worker 'worker', which may push further tasks
+typedef void (*TaskRun)(void* context, size_t task, unsigned worker);
+
+// Tasks of one worker, taken from the bottom by the owner and stolen from the top by the others
+typedef struct WorkDeque
+{
+    _Alignas(64) atomic_int_fast64_t top;
+    _Alignas(64) atomic_int_fast64_t bottom;
+    atomic_size_t*     tasks;
+    int64_t            mask;  // Capacity - 1, a power of two
+    struct ThreadPool* pool;
+    unsigned           worker;
+} WorkDeque;
+
+typedef struct ThreadPool
+{
+    WorkDeque*    deques;
+    Thread*       threads;
+    unsigned      count;
+    TaskRun       run;
+    void*         context;
+    atomic_size_t pending;  // Pushed tasks not finished yet
+} ThreadPool;
+
+// Each deque takes 'capacity' tasks at most, which is rounded up to a power of two
+bool initializeThreadPool(ThreadPool* pool, unsigned workers, size_t capacity, TaskRun run, void* context);
+
+void finalizeThreadPool(ThreadPool* pool);
+
+// Grows each deque to 'capacity' tasks between runs, so one pool serves any number of them
+bool reserveThreadPool(ThreadPool* pool, size_t capacity);
+
+// Adds a task for 'worker', before running or from a task running on 'worker'
+bool pushTask(ThreadPool* pool, unsigned worker, size_t task);
+
+// Runs all tasks on the workers, the calling thread is worker 0. Returns when all are done.
+void runThreadPool(ThreadPool* pool);
+
+#endif  // HEADER_POOL
@@ -0,0 +1,212 @@
+#include "socket.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#else
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef IO_REPARSE_TAG_AF_UNIX
+#define IO_REPARSE_TAG_AF_UNIX 0x80000023
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/*
+ * Private helpers
+ */
+
+// Fills in the address, false if the path does not fit
+bool socketAddress(struct sockaddr_un* address, const char* path)
+{
+    size_t length = strlen(path);
+    if(length >= sizeof(address->sun_path))
+        return false;
+
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, path, length + 1);
+    return true;
+}
+
+#ifdef _WIN32
+
+bool openSocket(Socket* connection)
+{
+    // Started once for the whole process, which ends it on exit
+    static bool started = false;
+    WSADATA     data;
+    if(!started && WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        return false;
+
+    started            = true;
+    SOCKET handle      = socket(AF_UNIX, SOCK_STREAM, 0);
+    connection->handle = handle != INVALID_SOCKET ? (intptr_t)handle : -1;
+    return connection->handle != -1;
+}
+
+#else
+
+bool openSocket(Socket* connection)
+{
+    connection->handle = socket(AF_UNIX, SOCK_STREAM, 0);
+    return connection->handle != -1;
+}
+
+#endif
+
+/*
+ * Local sockets
+ */
+
+bool listenSocket(Socket* server, const char* path)
+{
+    // Some server still answers there
+    Socket             running;
+    struct sockaddr_un address;
+    if(connectSocket(&running, path))
+    {
+        closeSocket(&running);
+        return false;
+    }
+    if(!socketAddress(&address, path) || !removeSocket(path) || !openSocket(server))
+        return false;
+
+#ifndef _WIN32
+    // Only this user may send files to compile
+    mode_t mask = umask(0077);
+#endif
+    bool bound = bind(server->handle, (struct sockaddr*)&address, sizeof(address)) == 0;
+#ifndef _WIN32
+    umask(mask);
+#endif
+
+    if(!bound || listen(server->handle, 16) != 0)
+    {
+        closeSocket(server);
+        return false;
+    }
+    return true;
+}
+
+bool acceptSocket(Socket* server, Socket* client)
+{
+#ifdef _WIN32
+    SOCKET handle  = accept((SOCKET)server->handle, NULL, NULL);
+    client->handle = handle != INVALID_SOCKET ? (intptr_t)handle : -1;
+#else
+    client->handle = accept(server->handle, NULL, NULL);
+#endif
+    return client->handle != -1;
+}
+
+bool connectSocket(Socket* connection, const char* path)
+{
+    struct sockaddr_un address;
+    if(!socketAddress(&address, path) || !openSocket(connection))
+        return false;
+
+    if(connect(connection->handle, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        closeSocket(connection);
+        return false;
+    }
+    return true;
+}
+
+bool sendSocket(Socket* connection, const void* data, size_t size)
+{
+    // A client that went away fails the send instead of ending the server
+    const char* bytes = data;
+    while(size > 0)
+    {
+        int chunk = size < 1 << 30 ? (int)size : 1 << 30;
+        int sent  = send(connection->handle, bytes, chunk, MSG_NOSIGNAL);
+        if(sent <= 0)
+            return false;
+
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+bool receiveSocket(Socket* connection, void* data, size_t size)
+{
+    char* bytes = data;
+    while(size > 0)
+    {
+        int chunk    = size < 1 << 30 ? (int)size : 1 << 30;
+        int received = recv(connection->handle, bytes, chunk, 0);
+        if(received <= 0)
+            return false;
+
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+bool limitSocket(Socket* connection, unsigned milliseconds)
+{
+#ifdef _WIN32
+    DWORD limit = milliseconds;
+#else
+    struct timeval limit = {.tv_sec = milliseconds / 1000, .tv_usec = (milliseconds % 1000) * 1000};
+#endif
+    return setsockopt(connection->handle, SOL_SOCKET, SO_RCVTIMEO, (const char*)&limit, sizeof(limit)) == 0 &&
+           setsockopt(connection->handle, SOL_SOCKET, SO_SNDTIMEO, (const char*)&limit, sizeof(limit)) == 0;
+}
+
+void closeSocket(Socket* connection)
+{
+    if(connection->handle == -1)
+        return;
+
+#ifdef _WIN32
+    closesocket((SOCKET)connection->handle);
+#else
+    close(connection->handle);
+#endif
+    connection->handle = -1;
+}
+
+#ifdef _WIN32
+
+bool removeSocket(const char* path)
+{
+    // Sockets are reparse points of their own tag
+    WIN32_FIND_DATAA found;
+    HANDLE           search = FindFirstFileA(path, &found);
+    if(search == INVALID_HANDLE_VALUE)
+        return GetLastError() == ERROR_FILE_NOT_FOUND || GetLastError() == ERROR_PATH_NOT_FOUND;
+
+    FindClose(search);
+    if(!(found.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) || found.dwReserved0 != IO_REPARSE_TAG_AF_UNIX)
+        return false;
+    return DeleteFileA(path) != 0;
+}
+
+#else
+
+bool removeSocket(const char* path)
+{
+    struct stat info;
+    if(lstat(path, &info) != 0)
+        return errno == ENOENT;
+    if(!S_ISSOCK(info.st_mode))
+        return false;
+    return unlink(path) == 0;
+}
+
+#endif
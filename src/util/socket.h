@@ -0,0 +1,41 @@
+#ifndef HEADER_SOCKET
+#define HEADER_SOCKET
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Local sockets
+ */
+
+// Stream socket bound to a path, -1 when closed
+typedef struct Socket
+{
+    intptr_t handle;
+} Socket;
+
+// Binds a new socket to 'path' for this user only and listens on it. A socket left
+// behind by a server that is gone is replaced, any other file is left alone.
+bool listenSocket(Socket* server, const char* path);
+
+// Waits for the next client
+bool acceptSocket(Socket* server, Socket* client);
+
+bool connectSocket(Socket* connection, const char* path);
+
+// Sends or receives exactly 'size' bytes, false if the other side is gone
+bool sendSocket(Socket* connection, const void* data, size_t size);
+
+bool receiveSocket(Socket* connection, void* data, size_t size);
+
+// Fails sends and receives that wait longer than 'milliseconds'
+bool limitSocket(Socket* connection, unsigned milliseconds);
+
+void closeSocket(Socket* connection);
+
+// Removes the file of a socket that no longer listens. Returns false if 'path'
+// is something else, which is kept.
+bool removeSocket(const char* path);
+
+#endif  // HEADER_SOCKET
@@ -0,0 +1,57 @@
+#include "text.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Text buffer
+ */
+
+void initializeTextBuffer(TextBuffer* buffer)
+{
+    buffer->text     = NULL;
+    buffer->size     = 0;
+    buffer->capacity = 0;
+}
+
+void finalizeTextBuffer(TextBuffer* buffer)
+{
+    free(buffer->text);
+    initializeTextBuffer(buffer);
+}
+
+bool appendText(TextBuffer* buffer, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    bool appended = appendTextV(buffer, fmt, args);
+    va_end(args);
+    return appended;
+}
+
+bool appendTextV(TextBuffer* buffer, const char* fmt, va_list args)
+{
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    if(length < 0)
+        return false;
+
+    if(buffer->size + (size_t)length + 1 > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity : 256;
+        while(capacity < buffer->size + (size_t)length + 1)
+            capacity *= 2;
+
+        char* text = realloc(buffer->text, capacity);
+        if(text == NULL)
+            return false;
+
+        buffer->text     = text;
+        buffer->capacity = capacity;
+    }
+
+    vsnprintf(buffer->text + buffer->size, (size_t)length + 1, fmt, args);
+    buffer->size += (size_t)length;
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef HEADER_TEXT
+#define HEADER_TEXT
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Text buffer
+ */
+
+// Formatted text collected to be printed later, always zero terminated
+typedef struct TextBuffer
+{
+    char*  text;
+    size_t size;
+    size_t capacity;
+} TextBuffer;
+
+void initializeTextBuffer(TextBuffer* buffer);
+
+void finalizeTextBuffer(TextBuffer* buffer);
+
+bool appendText(TextBuffer* buffer, const char* fmt, ...);
+
+bool appendTextV(TextBuffer* buffer, const char* fmt, va_list args);
+
+#endif  // HEADER_TEXT
@@ -0,0 +1,91 @@
+#include "thread.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Private helpers
+ */
+
+#ifdef _WIN32
+
+DWORD WINAPI runThread(LPVOID parameter)
+{
+    Thread* thread = parameter;
+    thread->main(thread->context);
+    return 0;
+}
+
+#else
+
+void* runThread(void* parameter)
+{
+    Thread* thread = parameter;
+    thread->main(thread->context);
+    return NULL;
+}
+
+#endif
+
+/*
+ * Threads
+ */
+
+#ifdef _WIN32
+
+bool startThread(Thread* thread, ThreadMain main, void* context)
+{
+    thread->main    = main;
+    thread->context = context;
+    thread->handle  = CreateThread(NULL, 0, runThread, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+void joinThread(Thread* thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void yieldThread(void)
+{
+    SwitchToThread();
+}
+
+unsigned processorCount(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (unsigned)info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+bool startThread(Thread* thread, ThreadMain main, void* context)
+{
+    thread->main    = main;
+    thread->context = context;
+    return pthread_create(&thread->handle, NULL, runThread, thread) == 0;
+}
+
+void joinThread(Thread* thread)
+{
+    pthread_join(thread->handle, NULL);
+}
+
+void yieldThread(void)
+{
+    sched_yield();
+}
+
+unsigned processorCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1;
+}
+
+#endif
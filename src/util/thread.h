@@ -0,0 +1,37 @@
+#ifndef HEADER_THREAD
+#define HEADER_THREAD
+
+#include <stdbool.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/*
+ * Threads
+ */
+
+typedef void (*ThreadMain)(void* context);
+
+typedef struct Thread
+{
+#ifdef _WIN32
+    void* handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadMain main;
+    void*      context;
+} Thread;
+
+bool startThread(Thread* thread, ThreadMain main, void* context);
+
+void joinThread(Thread* thread);
+
+// Gives up the rest of the time slice while waiting for another thread
+void yieldThread(void);
+
+// Logical processors available to this process, at least 1
+unsigned processorCount(void);
+
+#endif  // HEADER_THREAD
@@ -0,0 +1,122 @@
+// Searches the multiplier of the perfect hash of src/lexer/reserved.c and prints the
+// defines and the table that go there. Add new reserved words to the list below, run
+// 'make reserved' and paste the output over the old ones.
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RESERVED_HASH_BITS 6
+#define RESERVED_SLOTS (1 << RESERVED_HASH_BITS)
+
+// Tried before giving up, a word more than the slots can take needs more bits
+#define SEARCH_LIMIT 100000000
+
+typedef struct ReservedWord
+{
+    const char* word;
+    const char* tok;
+    const char* id;
+} ReservedWord;
+
+static const ReservedWord reservedWords[] = {
+    {"and", "TKKeyword", "KWAnd"},
+    {"as", "TKKeyword", "KWAs"},
+    {"dat", "TKKeyword", "KWDat"},
+    {"elif", "TKKeyword", "KWElif"},
+    {"else", "TKKeyword", "KWElse"},
+    {"end", "TKKeyword", "KWEnd"},
+    {"for", "TKKeyword", "KWFor"},
+    {"fun", "TKKeyword", "KWFun"},
+    {"if", "TKKeyword", "KWIf"},
+    {"in", "TKKeyword", "KWIn"},
+    {"is", "TKKeyword", "KWIs"},
+    {"mod", "TKKeyword", "KWMod"},
+    {"or", "TKKeyword", "KWOr"},
+    {"ret", "TKKeyword", "KWRet"},
+    {"while", "TKKeyword", "KWWhile"},
+    {"use", "TKKeyword", "KWUse"},
+    {"not", "TKKeyword", "KWNot"},
+    {"Bool", "TKType", "TYBool"},
+    {"Char", "TKType", "TYChar"},
+    {"U8", "TKType", "TYU8"},
+    {"U16", "TKType", "TYU16"},
+    {"U32", "TKType", "TYU32"},
+    {"U64", "TKType", "TYU64"},
+    {"S8", "TKType", "TYS8"},
+    {"S16", "TKType", "TYS16"},
+    {"S32", "TKType", "TYS32"},
+    {"S64", "TKType", "TYS64"},
+    {"F32", "TKType", "TYF32"},
+    {"F64", "TKType", "TYF64"},
+    {"F", "TKType", "TYF"},
+    {"true", "TKBooleanConstant", "1"},
+    {"false", "TKBooleanConstant", "0"},
+    {"nil", "TKNilConstant", "0"},
+    {"nop", "TKNop", "0"},
+    {"asm", "TKAsm", "0"},
+};
+
+#define RESERVED_COUNT (sizeof(reservedWords) / sizeof(reservedWords[0]))
+
+// Same as reservedHash in src/lexer/reserved.c
+unsigned reservedHash(const char* text, size_t length, uint32_t multiplier)
+{
+    uint32_t key = (uint32_t)(unsigned char)text[0] | (uint32_t)(unsigned char)text[length - 1] << 8 |
+                   (uint32_t)(unsigned char)text[length / 2] << 16 | (uint32_t)length << 24;
+    return (key * multiplier) >> (32 - RESERVED_HASH_BITS);
+}
+
+// Fills the slot of each word, false if two share one
+bool placeWords(uint32_t multiplier, int* slots)
+{
+    for(unsigned i = 0; i < RESERVED_SLOTS; ++i)
+        slots[i] = -1;
+
+    for(unsigned i = 0; i < RESERVED_COUNT; ++i)
+    {
+        unsigned slot = reservedHash(reservedWords[i].word, strlen(reservedWords[i].word), multiplier);
+        if(slots[slot] != -1)
+            return false;
+        slots[slot] = (int)i;
+    }
+    return true;
+}
+
+int main(void)
+{
+    // Odd multipliers from a fixed sequence, so the same words always give the same table
+    int      slots[RESERVED_SLOTS];
+    uint32_t state = 0x9e3779b9u;
+    for(unsigned tries = 0; tries < SEARCH_LIMIT; ++tries)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        uint32_t multiplier = state | 1;
+        if(!placeWords(multiplier, slots))
+            continue;
+
+        printf("#define RESERVED_HASH_MULTIPLIER 0x%08xu\n", multiplier);
+        printf("#define RESERVED_HASH_BITS %d\n\n", RESERVED_HASH_BITS);
+        printf("typedef struct ReservedWord\n{\n    const char*   word;\n    unsigned char length;\n"
+               "    unsigned char tok;\n    unsigned char id;\n} ReservedWord;\n\n");
+        printf("static const ReservedWord reservedWords[1 << RESERVED_HASH_BITS] = {\n");
+        for(unsigned slot = 0; slot < RESERVED_SLOTS; ++slot)
+        {
+            if(slots[slot] == -1)
+                continue;
+
+            const ReservedWord* reserved = &reservedWords[slots[slot]];
+            printf("    [%u] = {\"%s\", %zu, %s, %s},\n", slot, reserved->word, strlen(reserved->word), reserved->tok,
+                   reserved->id);
+        }
+        printf("};\n");
+        return 0;
+    }
+
+    fprintf(stderr, "No multiplier puts the %zu words into their own slots, raise RESERVED_HASH_BITS\n",
+            (size_t)RESERVED_COUNT);
+    return 1;
+}